@@ -4,20 +4,181 @@
 
 #ifndef BOOST_LOG_ASYNCLOGGER_H
 #define BOOST_LOG_ASYNCLOGGER_H
+#include <iterator>
 #include <memory>
 
 #include "spdlog/logger.h"
 #include "spdlog/async.h"
+#include "spdlog/details/periodic_worker.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/durable_file_sink.h"
+#ifndef _WIN32
+#include "spdlog/sinks/mmap_file_sink.h"
+#endif
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/sinks/segmented_file_sink.h"
+#ifndef _WIN32
+#include "spdlog/sinks/serial_sink.h"
+#include "spdlog/sinks/uring_file_sink.h"
+#endif
 #include "spdlog/spdlog.h"
+#include "spdlog/static_pattern_formatter.h"
 
 #include "spdlog/fmt/bin_to_hex.h"
 
 namespace util::log {
+    /// Способ ротации файла логов.
+    enum class RotationMode {
+        /// InfoLog.log -> InfoLog.1.log -> ..., переименование старых файлов выполняет вспомогательный поток.
+        renameInBackground,
+        /**
+         * Без переименований: каждый новый файл получает следующий номер
+         * (InfoLog.000001.log, InfoLog.000002.log, ...), InfoLog.current.log - ссылка на текущий файл,
+         * при ротации удаляется только самый старый файл.
+         */
+        segmented,
+#ifndef _WIN32
+        /**
+         * Как renameInBackground, но запись через отображение файла в память: файл сразу выделяется
+         * размером MAX_LOG_FILE_SIZE, сообщения копируются в него без буфера stdio и системных вызовов,
+         * при ротации и закрытии файл обрезается до записанной длины.
+         * Переименование старых файлов выполняется при ротации, в потоке записи. Только POSIX.
+         */
+        mmap,
+        /**
+         * Как mmap, но запись через io_uring: рабочий поток не ждет записи на диск, пока не заполнены
+         * все буферы синка. При ротации ожидается запись текущего файла, затем старые файлы переименовываются.
+         * Буферы дописываются на диск не реже AsyncLoggerConfig::fileFlushInterval.
+         * Только POSIX, без io_uring (не Linux или старое ядро) запись выполняется вызовом write().
+         */
+        uring
+#endif
+    };
+
+    /**
+     * Настройки пула потоков асинхронного логгера.
+     *
+     * @example
+        auto pool = std::make_shared<spdlog::details::thread_pool>(262144, 1);<br>
+        AsyncLogger first({.threadPool = pool, .name = "first"});<br>
+        AsyncLogger second({.threadPool = pool, .name = "second"});<br>
+     */
+    struct AsyncLoggerConfig {
+        /// Емкость очереди сообщений.
+        std::size_t queueSize = 8192;
+        /// Количество рабочих потоков.
+        std::size_t threadCount = 1;
+        /**
+         * Поведение при переполнении очереди: ожидание, вытеснение самого старого сообщения или
+         * async_overflow_policy::shed_by_level - отбрасывание info и warn по порогам заполнения,
+         * error и critical не отбрасываются никогда.
+         */
+        spdlog::async_overflow_policy overflowPolicy = spdlog::async_overflow_policy::block;
+        /// Доля заполнения очереди, начиная с которой отбрасываются info (для shed_by_level).
+        float infoShedWatermark = 0.75f;
+        /// Доля заполнения очереди, начиная с которой отбрасываются warn (для shed_by_level).
+        float warnShedWatermark = 0.9f;
+        /// Период записи сообщения "N info / M warning messages shed" (для shed_by_level).
+        std::chrono::milliseconds shedReportInterval{1000};
+        /**
+         * Реализация очереди пула потоков. async_queue_type::mpsc_lockfree -
+         * lock-free кольцевой буфер без блокировок на стороне вызывающих потоков,
+         * async_queue_type::per_thread_spsc - отдельный буфер на perThreadQueueSize сообщений для
+         * каждого пишущего потока, queueSize не используется. Буфер выделяется целиком при первой
+         * записи из потока, поэтому память очереди - число пишущих потоков * perThreadQueueSize *
+         * sizeof(async_msg) (около 420 байт). Не совместим с overrun_oldest: конструктор выбросит spdlog_ex.
+         * async_queue_type::byte_ring - записи переменной длины в заранее выделенном байтовом буфере
+         * (queueSize * 128 байт), без выделения памяти на каждое сообщение, например для вывода toHex.
+         */
+        spdlog::async_queue_type queueType = spdlog::async_queue_type::mpmc_blocking;
+        /// Емкость буфера каждого пишущего потока (для async_queue_type::per_thread_spsc).
+        std::size_t perThreadQueueSize = spdlog::details::default_thread_q_max_items;
+        /**
+         * Емкость отдельной очереди для сообщений error и critical, которую рабочий поток всегда
+         * разбирает первой, например 1024. По умолчанию 0 - отдельная очередь не создается: error и critical
+         * идут в общую очередь, порядок сообщений разных уровней сохраняется.
+         */
+        std::size_t priorityQueueSize = 0;
+        /**
+         * Ожидание рабочего потока при пустой очереди. async_wait_strategy::spin_park - опрос очереди,
+         * затем сон на futex, вызывающий поток будит рабочий только если тот действительно спит;
+         * async_wait_strategy::spin_yield - опрос с уступкой процессора;
+         * async_wait_strategy::busy_spin - непрерывный опрос, занимает ядро целиком.
+         */
+        spdlog::async_wait_strategy waitStrategy = spdlog::async_wait_strategy::blocking;
+        /**
+         * Форматировать сообщение один раз и передавать готовую строку всем синкам с тем же форматом
+         * (включая цветовой диапазон для консоли), вместо форматирования в каждом синке.
+         */
+        bool sharedFormatting = true;
+        /**
+         * Общий пул потоков. Если задан, queueSize, threadCount, queueType, perThreadQueueSize,
+         * priorityQueueSize и waitStrategy не используются.
+         */
+        std::shared_ptr<spdlog::details::thread_pool> threadPool;
+        /// Имя логгера в реестре spdlog.
+        std::string name = "Logger";
+        /// Способ ротации файла логов.
+        RotationMode rotationMode = RotationMode::renameInBackground;
+#ifndef _WIN32
+        /**
+         * Период дозаписи на диск буферов файла логов для RotationMode::uring: без новых сообщений
+         * неполный буфер иначе ждал бы следующих записей. Ноль - дозапись только при заполнении буфера и flush().
+         */
+        std::chrono::milliseconds fileFlushInterval{1000};
+#endif
+#ifndef _WIN32
+        /**
+         * Последовательный порт (например "/dev/ttyS0") для дополнительного вывода логов.
+         * Пустая строка - вывод в порт не используется. Только POSIX.
+         */
+        std::string serialDevice;
+        /// Скорость последовательного порта.
+        int serialBaudRate = 115200;
+        /**
+         * Поведение при переполнении буфера порта: serial_overflow_policy::drop - сообщение отбрасывается,
+         * рабочий поток не ждет медленную линию; serial_overflow_policy::block - ожидание линии.
+         */
+        spdlog::sinks::serial_overflow_policy serialOverflowPolicy = spdlog::sinks::serial_overflow_policy::drop;
+        /// Размер кольцевого буфера порта в байтах.
+        std::size_t serialBufferSize = 16 * 1024;
+        /**
+         * Период дозаписи в порт остатка буфера: без новых сообщений хвост пачки иначе ждал бы
+         * следующей записи. Ноль - дозапись только при записи и flush().
+         */
+        std::chrono::milliseconds serialFlushInterval{100};
+#endif
+        /**
+         * Групповая запись на диск сообщений critical файла ExceptionLog.log: сообщения, пришедшие
+         * за durableCommitWindow, записываются на диск одним вызовом fdatasync. См. criticalDurable().
+         */
+        bool durableExceptionLog = false;
+        /// Окно группировки сообщений перед fdatasync (для durableExceptionLog).
+        std::chrono::milliseconds durableCommitWindow{2};
+    };
+
+    /**
+     * Формат по умолчанию "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ", разобранный на этапе компиляции:
+     * вывод тот же, что у spdlog::pattern_formatter, но без разбора шаблона и виртуального вызова на каждый флаг.
+     */
+    using DefaultFormat = spdlog::static_pattern_formatter<
+            spdlog::static_pattern::text<'['>, spdlog::static_pattern::flag<'D'>, spdlog::static_pattern::text<' '>,
+            spdlog::static_pattern::flag<'H'>, spdlog::static_pattern::text<':'>, spdlog::static_pattern::flag<'M'>,
+            spdlog::static_pattern::text<':'>, spdlog::static_pattern::flag<'S'>, spdlog::static_pattern::text<':'>,
+            spdlog::static_pattern::flag<'f'>, spdlog::static_pattern::text<']', '['>, spdlog::static_pattern::flag<'n'>,
+            spdlog::static_pattern::text<']', '['>, spdlog::static_pattern::flag<'^'>, spdlog::static_pattern::flag<'L'>,
+            spdlog::static_pattern::flag<'$'>, spdlog::static_pattern::text<']', ' ', ':', ' '>,
+            spdlog::static_pattern::flag<'v'>, spdlog::static_pattern::text<' '>>;
+
     /**
      * Класс осуществляющий асинхронное логгирование.
+     * Работа рабочего потока при ротации файла логов зависит от AsyncLoggerConfig::rotationMode:
+     * RotationMode::renameInBackground - одно переименование текущего файла и открытие нового,
+     * остальные файлы переименовывает вспомогательный поток;
+     * RotationMode::segmented - открытие следующего файла, обновление ссылки и удаление самого старого файла;
+     * RotationMode::mmap - переименование всех старых файлов и отображение нового файла в память;
+     * RotationMode::uring - ожидание записи текущего файла и переименование всех старых файлов.
      *
      * @note https://spdlog.docsforge.com/v1.x/getting-started/
      * @example
@@ -34,18 +195,21 @@ namespace util::log {
         uint32_t MAX_LOG_FILE_NUMBER = 10;
 
     public:
-        AsyncLogger() :
+        /// Строка формата info(fmt, args...) и подобных, см. spdlog::basic_deferred_format_string.
+        template<typename... Args>
+        using FormatString = spdlog::deferred_format_string_t<Args...>;
+
+        /**
+         * @param _config Настройки пула потоков. По умолчанию каждый экземпляр создает собственный пул,
+         * глобальный пул spdlog не затрагивается.
+         */
+        explicit AsyncLogger(const AsyncLoggerConfig &_config = {}) :
                 consoleSink(std::make_shared<spdlog::sinks::stdout_color_sink_mt>()),
-                rotateFileSink(std::make_shared<spdlog::sinks::rotating_file_sink_mt>("logs/InfoLog.log",
-                                                                                      AsyncLogger::MAX_LOG_FILE_SIZE,
-                                                                                      AsyncLogger::MAX_LOG_FILE_NUMBER)),
-                exceptionFileSink(std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/ExceptionLog.log")),
+                rotateFileSink(makeRotateFileSink("logs/InfoLog.log", AsyncLogger::MAX_LOG_FILE_SIZE,
+                                                  AsyncLogger::MAX_LOG_FILE_NUMBER, _config)),
+                exceptionFileSink(makeExceptionFileSink(_config)),
                 sinks{consoleSink, rotateFileSink, exceptionFileSink} {
-            spdlog::init_thread_pool(8192, 1);
-            multiSinkLog = std::make_shared<spdlog::async_logger>(
-                    spdlog::async_logger("Logger", sinks.begin(), sinks.end(), spdlog::thread_pool(),
-                                         spdlog::async_overflow_policy::block));
-            spdlog::register_logger(multiSinkLog);
+            initLogger(_config);
             consoleSink->set_level(spdlog::level::info); //4
 
             rotateFileSink->set_level(spdlog::level::info); //4
@@ -53,21 +217,17 @@ namespace util::log {
             exceptionFileSink->set_level(spdlog::level::critical); //7
 
             multiSinkLog->set_level(spdlog::level::info); //5
-            multiSinkLog->set_pattern(AsyncLogger::format);
+            setFormat<DefaultFormat>();
 
         }
 
-        AsyncLogger(const std::string &_fileLogPath, std::uint16_t _fileLogFileSize, std::uint16_t _fileLogFileNumber) :
+        AsyncLogger(const std::string &_fileLogPath, std::uint16_t _fileLogFileSize, std::uint16_t _fileLogFileNumber,
+                    const AsyncLoggerConfig &_config = {}) :
                 consoleSink(std::make_shared<spdlog::sinks::stdout_color_sink_mt>()),
-                rotateFileSink(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(_fileLogPath, _fileLogFileSize,
-                                                                                      _fileLogFileNumber)),
-                exceptionFileSink(std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/ExceptionLog.log")),
+                rotateFileSink(makeRotateFileSink(_fileLogPath, _fileLogFileSize, _fileLogFileNumber, _config)),
+                exceptionFileSink(makeExceptionFileSink(_config)),
                 sinks{consoleSink, rotateFileSink, exceptionFileSink} {
-            spdlog::init_thread_pool(8192, 1);
-            multiSinkLog = std::make_shared<spdlog::async_logger>(
-                    spdlog::async_logger("Logger", sinks.begin(), sinks.end(), spdlog::thread_pool(),
-                                         spdlog::async_overflow_policy::block));
-            spdlog::register_logger(multiSinkLog);
+            initLogger(_config);
 
             consoleSink->set_level(spdlog::level::info); //4
 
@@ -76,10 +236,20 @@ namespace util::log {
             exceptionFileSink->set_level(spdlog::level::critical); //7
 
             multiSinkLog->set_level(spdlog::level::info); //5
-            multiSinkLog->set_pattern(AsyncLogger::format);
+            setFormat<DefaultFormat>();
 
         }
 
+        AsyncLogger(const AsyncLogger &) = delete;
+
+        AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+        ~AsyncLogger() {
+            if (spdlog::get(multiSinkLog->name()) == multiSinkLog) {
+                spdlog::drop(multiSinkLog->name());
+            }
+        }
+
         void consoleSinkOff() {
             consoleSink->set_level(spdlog::level::off); //4
         }
@@ -126,6 +296,33 @@ namespace util::log {
             return spdlog::to_hex(std::forward<decltype(msg)>(msg));
         }
 
+        /**
+         * Шестнадцатеричный дамп буфера с отложенным форматированием: в очередь копируются только байты буфера,
+         * дамп (такой же, как у info(toHex(buf))) строится в потоке логгера.
+         *
+         * @param buf Контейнер или массив однобайтовых элементов.
+         * @example log.infoHex(frame);
+         */
+        template<typename Container>
+        void infoHex(const Container &buf) {
+            logHex(spdlog::level::info, buf);
+        }
+
+        template<typename Container>
+        void warnHex(const Container &buf) {
+            logHex(spdlog::level::warn, buf);
+        }
+
+        template<typename Container>
+        void errorHex(const Container &buf) {
+            logHex(spdlog::level::err, buf);
+        }
+
+        template<typename Container>
+        void criticalHex(const Container &buf) {
+            logHex(spdlog::level::critical, buf);
+        }
+
         template<typename T>
         void info(const T &&msg) {
             multiSinkLog->info(std::forward<decltype(msg)>(msg));
@@ -136,6 +333,21 @@ namespace util::log {
             multiSinkLog->info(std::forward<decltype(msg)>(msg));
         }
 
+        /**
+         * Запись с отложенным форматированием: если все аргументы арифметических типов, перечисления
+         * или void*, в очередь копируются только указатель на строку формата и значения аргументов,
+         * само форматирование выполняется в потоке логгера. С аргументами других типов
+         * (например std::string) сообщение форматируется сразу, в вызывающем потоке.
+         *
+         * @param fmt Строка формата, известная на этапе компиляции (строковый литерал), fmt::runtime не принимается.
+         * @param args Аргументы.
+         * @example log.info("Received {} bytes in {} us", size, elapsed);
+         */
+        template<typename Arg, typename... Args>
+        void info(FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            logFormatted<Arg, Args...>(spdlog::level::info, fmt, arg, args...);
+        }
+
         template<typename T>
         void warn(const T &&msg) {
             multiSinkLog->warn(std::forward<decltype(msg)>(msg));
@@ -146,6 +358,11 @@ namespace util::log {
             multiSinkLog->warn(std::forward<decltype(msg)>(msg));
         }
 
+        template<typename Arg, typename... Args>
+        void warn(FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            logFormatted<Arg, Args...>(spdlog::level::warn, fmt, arg, args...);
+        }
+
         template<typename T>
         void error(const T &&msg) {
             multiSinkLog->error(std::forward<decltype(msg)>(msg));
@@ -156,6 +373,11 @@ namespace util::log {
             multiSinkLog->error(std::forward<decltype(msg)>(msg));
         }
 
+        template<typename Arg, typename... Args>
+        void error(FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            logFormatted<Arg, Args...>(spdlog::level::err, fmt, arg, args...);
+        }
+
 
         template<typename T>
         void critical(const T &&msg) {
@@ -167,20 +389,169 @@ namespace util::log {
             multiSinkLog->critical(std::forward<decltype(msg)>(msg));
         }
 
+        template<typename Arg, typename... Args>
+        void critical(FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            logFormatted<Arg, Args...>(spdlog::level::critical, fmt, arg, args...);
+        }
+
+        /**
+         * critical() с ожиданием записи сообщения на диск в ExceptionLog.log.
+         * Требует AsyncLoggerConfig::durableExceptionLog.
+         *
+         * @param _timeout Максимальное время ожидания.
+         * @return true, если сообщение записано на диск; false по истечении _timeout, без durableExceptionLog
+         * или если сообщение не попадает в ExceptionLog.log по уровню.
+         */
+        template<typename T>
+        bool criticalDurable(T &&msg, std::chrono::milliseconds _timeout = std::chrono::seconds(1)) {
+            if (!durableExceptionSink || !multiSinkLog->should_log(spdlog::level::critical) ||
+                !durableExceptionSink->should_log(spdlog::level::critical)) {
+                critical(std::forward<T>(msg));
+                return false;
+            }
+            // номер выдается самому сообщению, прочие сообщения critical на ожидание не влияют
+            auto sequence = durableExceptionSink->next_durable_sequence();
+            if constexpr (std::is_convertible_v<const T &, spdlog::string_view_t>) {
+                multiSinkLog->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, msg, sequence);
+            } else {
+                multiSinkLog->log_sequenced(spdlog::source_loc{}, spdlog::level::critical,
+                                            spdlog::fmt_lib::format("{}", msg), sequence);
+            }
+            return durableExceptionSink->wait_durable(sequence, _timeout);
+        }
+
     private:
+        template<typename... Args>
+        void logFormatted(spdlog::level::level_enum _lvl, FormatString<Args...> fmt, const Args &... args) {
+            if constexpr (spdlog::details::deferred_args<Args...>::deferrable) {
+                multiSinkLog->log_deferred(_lvl, fmt, args...);
+            } else {
+                // строка формата уже проверена при компиляции
+                multiSinkLog->log(_lvl, SPDLOG_FMT_RUNTIME(fmt.get()), args...);
+            }
+        }
+
+        template<typename Container>
+        void logHex(spdlog::level::level_enum _lvl, const Container &buf) {
+            static_assert(sizeof(*std::data(buf)) == 1, "logHex: only byte buffers can be dumped");
+            multiSinkLog->log_hex_deferred(_lvl, "{}", std::data(buf), std::size(buf));
+        }
+
+        /// Синк файла ExceptionLog.log, с групповой записью на диск, если задан AsyncLoggerConfig::durableExceptionLog.
+        static std::shared_ptr<spdlog::sinks::sink> makeExceptionFileSink(const AsyncLoggerConfig &_config) {
+            if (_config.durableExceptionLog) {
+                return std::make_shared<spdlog::sinks::durable_file_sink_mt>("logs/ExceptionLog.log", false,
+                                                                             spdlog::level::critical,
+                                                                             _config.durableCommitWindow);
+            }
+            return std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/ExceptionLog.log");
+        }
+
+        /**
+         * Синк файла логов с ротацией согласно AsyncLoggerConfig::rotationMode.
+         */
+        static std::shared_ptr<spdlog::sinks::sink> makeRotateFileSink(const std::string &_fileLogPath,
+                                                                       std::size_t _fileLogFileSize,
+                                                                       std::size_t _fileLogFileNumber,
+                                                                       const AsyncLoggerConfig &_config) {
+            switch (_config.rotationMode) {
+                case RotationMode::segmented:
+                    // текущий файл тоже входит в число хранимых
+                    return std::make_shared<spdlog::sinks::segmented_file_sink_mt>(_fileLogPath, _fileLogFileSize,
+                                                                                   _fileLogFileNumber + 1);
+#ifndef _WIN32
+                case RotationMode::mmap:
+                    return std::make_shared<spdlog::sinks::mmap_file_sink_mt>(_fileLogPath, _fileLogFileSize,
+                                                                              _fileLogFileNumber);
+                case RotationMode::uring:
+                    return std::make_shared<spdlog::sinks::rotating_uring_file_sink_mt>(_fileLogPath, _fileLogFileSize,
+                                                                                        _fileLogFileNumber);
+#endif
+                case RotationMode::renameInBackground:
+                    break;
+            }
+            return std::make_shared<spdlog::sinks::rotating_file_sink_mt>(_fileLogPath, _fileLogFileSize,
+                                                                          _fileLogFileNumber, false,
+                                                                          spdlog::file_event_handlers{}, true);
+        }
+
+        /**
+         * Создание логгера поверх общего или собственного пула потоков.
+         * Если логгер с таким именем уже зарегистрирован, регистрация остается за ним.
+         */
+        void initLogger(const AsyncLoggerConfig &_config) {
+            threadPool = _config.threadPool;
+            if (!threadPool) {
+                threadPool = std::make_shared<spdlog::details::thread_pool>(_config.queueSize, _config.threadCount,
+                                                                            _config.queueType,
+                                                                            _config.priorityQueueSize,
+                                                                            _config.waitStrategy,
+                                                                            _config.perThreadQueueSize);
+            }
+#ifndef _WIN32
+            if (!_config.serialDevice.empty()) {
+                spdlog::sinks::serial_sink_config serialConfig(_config.serialDevice, _config.serialBaudRate);
+                serialConfig.overflow_policy = _config.serialOverflowPolicy;
+                serialConfig.buffer_size = _config.serialBufferSize;
+                serialSink = std::make_shared<spdlog::sinks::serial_sink_mt>(serialConfig);
+                serialSink->set_level(spdlog::level::info);
+                sinks.push_back(serialSink);
+                // flush приемника порта не ждет линию, поэтому вызывается напрямую, мимо очереди логгера;
+                // ошибка порта (например, отключенный USB-UART) не должна завершать процесс
+                serialFlusher = std::make_unique<spdlog::details::periodic_worker>(
+                        [sink = serialSink] {
+                            SPDLOG_TRY {
+                                sink->flush();
+                            }
+                            SPDLOG_CATCH_STD
+                        }, _config.serialFlushInterval);
+            }
+            if (_config.rotationMode == RotationMode::uring) {
+                fileFlusher = std::make_unique<spdlog::details::periodic_worker>(
+                        [sink = rotateFileSink] {
+                            SPDLOG_TRY {
+                                sink->flush();
+                            }
+                            SPDLOG_CATCH_STD
+                        }, _config.fileFlushInterval);
+            }
+#endif
+            multiSinkLog = std::make_shared<spdlog::async_logger>(_config.name, sinks.begin(), sinks.end(), threadPool,
+                                                                  _config.overflowPolicy);
+            multiSinkLog->set_shed_watermarks(_config.infoShedWatermark, _config.warnShedWatermark,
+                                              _config.shedReportInterval);
+            multiSinkLog->set_shared_formatting(_config.sharedFormatting);
+            durableExceptionSink = std::dynamic_pointer_cast<spdlog::sinks::durable_file_sink_mt>(exceptionFileSink);
+            if (!spdlog::get(_config.name)) {
+                spdlog::register_logger(multiSinkLog);
+            }
+        }
+
         std::shared_ptr<spdlog::sinks::sink> consoleSink;
         std::shared_ptr<spdlog::sinks::sink> rotateFileSink;
         std::shared_ptr<spdlog::sinks::sink> exceptionFileSink;
+        /// Создается только если задан AsyncLoggerConfig::serialDevice.
+        std::shared_ptr<spdlog::sinks::sink> serialSink;
+        /// exceptionFileSink, если задан AsyncLoggerConfig::durableExceptionLog.
+        std::shared_ptr<spdlog::sinks::durable_file_sink_mt> durableExceptionSink;
 
         std::vector<spdlog::sink_ptr> sinks;
 
+        /// Пул должен пережить логгер: async_logger не владеет пулом.
+        std::shared_ptr<spdlog::details::thread_pool> threadPool;
+
         std::shared_ptr<spdlog::async_logger> multiSinkLog;
 
+        /// Периодическая дозапись буфера serialSink, см. AsyncLoggerConfig::serialFlushInterval.
+        std::unique_ptr<spdlog::details::periodic_worker> serialFlusher;
+        /// Периодическая дозапись буферов rotateFileSink, см. AsyncLoggerConfig::fileFlushInterval.
+        std::unique_ptr<spdlog::details::periodic_worker> fileFlusher;
+
         /**
          * Формат записываемых данных.
          * @copydoc https://spdlog.docsforge.com/v1.x/3.custom-formatting/#pattern-flags
          */
-        std::string format{"[%D %H:%M:%S:%f][%n][%^%L%$] : %v "};
+        std::string format{DefaultFormat::pattern()};
     public:
         const std::string &getFormat() const {
             return format;
@@ -212,10 +583,32 @@ namespace util::log {
             multiSinkLog->set_pattern(AsyncLogger::format);
         }
 
+        /**
+         * Установка формата, разобранного на этапе компиляции.
+         *
+         * @tparam Formatter spdlog::static_pattern_formatter<...>, например DefaultFormat.
+         */
+        template<typename Formatter>
+        void setFormat() {
+            AsyncLogger::format = Formatter::pattern();
+            multiSinkLog->set_formatter(std::make_unique<Formatter>());
+        }
+
         [[nodiscard]] const spdlog::logger &getMultiSinkLog() const {
             return *multiSinkLog;
         }
 
+        /**
+         * Количество сообщений уровня _lvl, отброшенных политикой shed_by_level.
+         */
+        [[nodiscard]] std::size_t getShedCount(spdlog::level::level_enum _lvl) const {
+            return multiSinkLog->shed_counter(_lvl);
+        }
+
+        [[nodiscard]] const std::shared_ptr<spdlog::details::thread_pool> &getThreadPool() const {
+            return threadPool;
+        }
+
     };
 
 }
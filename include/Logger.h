@@ -5,7 +5,18 @@
 #ifndef BOOST_LOG_LOGGER_H
 #define BOOST_LOG_LOGGER_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
 #include "AsyncLogger.h"
+#include "spdlog/sinks/level_router_sink.h"
 #include "SerialLogger.h"
 
 
@@ -28,13 +39,27 @@ namespace util::log {
         std::unique_ptr<Type> logger_;
 
     public:
-        Logger() : logger_()
+        Logger() : logger_(std::make_unique<Type>())
         {
 
         }
 
         Logger( const std::string& _fileLogPath, std::uint16_t _fileLogFileSize, std::uint16_t _fileLogFileNumber ):
-                logger_(_fileLogPath, _fileLogFileSize, _fileLogFileNumber)
+                logger_(std::make_unique<Type>(_fileLogPath, _fileLogFileSize, _fileLogFileNumber))
+        {
+        }
+
+        /**
+         * @param _config Настройки пула потоков асинхронного логгера.
+         */
+        explicit Logger( const AsyncLoggerConfig& _config ):
+                logger_(std::make_unique<Type>(_config))
+        {
+        }
+
+        Logger( const std::string& _fileLogPath, std::uint16_t _fileLogFileSize, std::uint16_t _fileLogFileNumber,
+                const AsyncLoggerConfig& _config ):
+                logger_(std::make_unique<Type>(_fileLogPath, _fileLogFileSize, _fileLogFileNumber, _config))
         {
         }
 
@@ -86,6 +111,36 @@ namespace util::log {
             return spdlog::to_hex( std::forward<decltype(msg)>( msg ) );
         }
 
+        /**
+         * Шестнадцатеричный дамп буфера, строится в потоке логгера.
+         *
+         * @param buf Контейнер или массив однобайтовых элементов.
+         * @example log.infoHex(frame);
+         */
+        template<typename Container>
+        void infoHex( const Container &buf )
+        {
+            logger_->infoHex( buf );
+        }
+
+        template<typename Container>
+        void warnHex( const Container &buf )
+        {
+            logger_->warnHex( buf );
+        }
+
+        template<typename Container>
+        void errorHex( const Container &buf )
+        {
+            logger_->errorHex( buf );
+        }
+
+        template<typename Container>
+        void criticalHex( const Container &buf )
+        {
+            logger_->criticalHex( buf );
+        }
+
         template<typename T>
         void info( const T &&msg )
         {
@@ -98,6 +153,19 @@ namespace util::log {
             logger_->info(std::forward<decltype( msg) >(msg ) );
         }
 
+        /**
+         * Запись с отложенным форматированием, форматирование выполняется в потоке логгера.
+         *
+         * @param fmt Строка формата, см. Type::FormatString (для AsyncLogger - строковый литерал).
+         * @param args Аргументы.
+         * @example log.info("Received {} bytes in {} us", size, elapsed);
+         */
+        template<typename Arg, typename... Args>
+        void info( typename Type::template FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args )
+        {
+            logger_->info( fmt, arg, args... );
+        }
+
         template<typename T>
         void warn( const T &&msg )
         {
@@ -110,6 +178,12 @@ namespace util::log {
             logger_->warn(std::forward<decltype( msg) >(msg ) );
         }
 
+        template<typename Arg, typename... Args>
+        void warn( typename Type::template FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args )
+        {
+            logger_->warn( fmt, arg, args... );
+        }
+
         template<typename T>
         void error( const T &&msg )
         {
@@ -122,6 +196,12 @@ namespace util::log {
             logger_->error(std::forward<decltype( msg) >(msg ) );
         }
 
+        template<typename Arg, typename... Args>
+        void error( typename Type::template FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args )
+        {
+            logger_->error( fmt, arg, args... );
+        }
+
 
         template<typename T>
         void critical( const T &&msg )
@@ -135,6 +215,12 @@ namespace util::log {
             logger_->critical(std::forward<decltype( msg) >(msg ) );
         }
 
+        template<typename Arg, typename... Args>
+        void critical( typename Type::template FormatString<Arg, Args...> fmt, const Arg &arg, const Args &... args )
+        {
+            logger_->critical( fmt, arg, args... );
+        }
+
 
     public:
         [[nodiscard]] const std::string &getFormat() const {
@@ -165,13 +251,258 @@ namespace util::log {
             logger_->setFormat(std::forward<decltype(_format)>(_format ));
         }
 
+        /**
+         * Установка формата, разобранного на этапе компиляции.
+         *
+         * @tparam Formatter spdlog::static_pattern_formatter<...>, например DefaultFormat.
+         */
+        template<typename Formatter>
+        void setFormat() {
+            logger_->template setFormat<Formatter>();
+        }
+
         [[nodiscard]] const spdlog::logger &getMultiSinkLog() const {
             return logger_->getMultiSinkLog();
         }
 
     };
 
+    namespace detail {
+        /// Шаблон, последний раз примененный к логгеру свободной функции из любого потока.
+        struct AppliedPattern {
+            std::mutex mutex;
+            std::string pattern;
+            /// Растет при каждой смене pattern, потоки сверяют его со своей копией без мьютекса.
+            std::atomic<size_t> generation{0};
+        };
+
+        /// Общие настройки свободных функций логирования.
+        struct FreeLogSettings {
+            std::mutex mutex;
+            /// Пул потоков асинхронного режима (enableAsyncFreeLogging).
+            std::shared_ptr<spdlog::details::thread_pool> threadPool;
+            spdlog::async_overflow_policy overflowPolicy = spdlog::async_overflow_policy::block;
+            float infoShedWatermark = 0.75f;
+            float warnShedWatermark = 0.9f;
+            std::chrono::milliseconds shedReportInterval{1000};
+            /// Общие файлы и буфер функций *LogToFile (routeFileLogs).
+            std::shared_ptr<spdlog::sinks::level_router> fileRouter;
+            /// Примененные шаблоны логгеров, см. appliedPattern.
+            std::vector<std::pair<std::weak_ptr<spdlog::logger>, std::shared_ptr<AppliedPattern>>> patterns;
+
+            FreeLogSettings() {
+                // реестр spdlog создается раньше и уничтожается позже пула,
+                // так что рабочий поток успевает записать оставшиеся сообщения
+                spdlog::details::registry::instance();
+            }
+        };
+
+        inline FreeLogSettings &freeLogSettings() {
+            static FreeLogSettings settings;
+            return settings;
+        }
+
+        /**
+         * Фабрика логгеров свободных функций: синхронный логгер или, после enableAsyncFreeLogging,
+         * асинхронный логгер поверх общего пула потоков. После routeFileLogs логгер файла, входящего
+         * в маршруты, пишет в этот файл через общий буфер, логгер остальных файлов - в собственный файл.
+         */
+        struct FreeLoggerFactory {
+            template<typename Sink, typename... SinkArgs>
+            static std::shared_ptr<spdlog::logger> create(std::string _logName, SinkArgs &&... _args) {
+                auto &settings = freeLogSettings();
+                std::unique_lock<std::mutex> lock(settings.mutex);
+                std::shared_ptr<spdlog::sinks::sink> sink;
+                if constexpr (std::is_same_v<Sink, spdlog::sinks::basic_file_sink_mt>) {
+                    const spdlog::filename_t &filepath = std::get<0>(std::forward_as_tuple(_args...));
+                    if (settings.fileRouter && settings.fileRouter->has_file(filepath)) {
+                        sink = std::make_shared<spdlog::sinks::level_router_sink_mt>(settings.fileRouter, filepath);
+                    }
+                }
+                auto threadPool = settings.threadPool;
+                auto overflowPolicy = settings.overflowPolicy;
+                auto infoShedWatermark = settings.infoShedWatermark;
+                auto warnShedWatermark = settings.warnShedWatermark;
+                auto shedReportInterval = settings.shedReportInterval;
+                lock.unlock();
+
+                if (!sink) {
+                    sink = std::make_shared<Sink>(std::forward<SinkArgs>(_args)...);
+                }
+                std::shared_ptr<spdlog::logger> logger;
+                if (threadPool) {
+                    auto asyncLogger = std::make_shared<spdlog::async_logger>(std::move(_logName), std::move(sink),
+                                                                              std::move(threadPool), overflowPolicy);
+                    asyncLogger->set_shed_watermarks(infoShedWatermark, warnShedWatermark, shedReportInterval);
+                    logger = std::move(asyncLogger);
+                } else {
+                    logger = std::make_shared<spdlog::logger>(std::move(_logName), std::move(sink));
+                }
+                spdlog::details::registry::instance().initialize_logger(logger);
+                return logger;
+            }
+        };
+
+        /**
+         * Общий для всех потоков шаблон логгера _logger. Берет мьютекс настроек,
+         * поэтому вызывается только при получении логгера, а не на каждую запись.
+         */
+        inline std::shared_ptr<AppliedPattern> appliedPattern(const std::shared_ptr<spdlog::logger> &_logger) {
+            auto &settings = freeLogSettings();
+            std::lock_guard<std::mutex> lock(settings.mutex);
+            auto &patterns = settings.patterns;
+            patterns.erase(std::remove_if(patterns.begin(), patterns.end(),
+                                          [](const auto &_entry) { return _entry.first.expired(); }),
+                           patterns.end());
+            for (auto &entry : patterns) {
+                if (!entry.first.owner_before(_logger) && !_logger.owner_before(entry.first)) {
+                    return entry.second;
+                }
+            }
+            patterns.emplace_back(_logger, std::make_shared<AppliedPattern>());
+            return patterns.back().second;
+        }
+
+        /**
+         * Логгер свободной функции, запомненный в потоке.
+         * spdlog::get берет мьютекс реестра и ищет логгер по имени, set_pattern заново разбирает шаблон
+         * и пересоздает форматтеры всех приемников, поэтому на каждый вызов это не делается.
+         * Примененный шаблон общий для всех потоков, поток держит его копию и поколение
+         * и берет мьютекс только когда его шаблон или поколение разошлись с копией.
+         */
+        struct CachedLogger {
+            std::string name;
+            std::weak_ptr<spdlog::logger> logger;
+            std::shared_ptr<AppliedPattern> pattern;
+            std::string lastPattern;
+            size_t generation = 0;
+        };
+
+        inline std::vector<CachedLogger> &loggerCache() {
+            thread_local std::vector<CachedLogger> cache;
+            return cache;
+        }
+
+        /**
+         * Логгер с именем _logName: из кэша потока, из реестра spdlog или созданный _factory.
+         * Удаленный из реестра логгер (spdlog::drop) находится и создается заново, как только он уничтожен.
+         *
+         * @param _pattern Шаблон вывода, применяется только при его изменении.
+         */
+        template<typename Factory>
+        inline std::shared_ptr<spdlog::logger> cachedLogger(const std::string &_logName, Factory &&_factory,
+                                                            const std::string_view *_pattern = nullptr) {
+            auto &cache = loggerCache();
+            auto entry = std::find_if(cache.begin(), cache.end(),
+                                      [&_logName](const CachedLogger &_cached) { return _cached.name == _logName; });
+            std::shared_ptr<spdlog::logger> logger;
+            if (entry != cache.end()) {
+                logger = entry->logger.lock();
+            }
+            if (!logger) {
+                logger = spdlog::get(_logName);
+                if (!logger) {
+                    logger = _factory();
+                }
+                if (entry == cache.end()) {
+                    entry = cache.insert(cache.end(), CachedLogger{_logName, {}, {}, {}, 0});
+                }
+                entry->logger = logger;
+                entry->pattern.reset();
+            }
+            if (_pattern) {
+                if (!entry->pattern) {
+                    entry->pattern = appliedPattern(logger);
+                    // поколение, которого еще не было: первый вызов сверяется с общим шаблоном под мьютексом
+                    entry->generation = entry->pattern->generation.load(std::memory_order_acquire) - 1;
+                }
+                auto &applied = *entry->pattern;
+                if (applied.generation.load(std::memory_order_acquire) == entry->generation &&
+                    entry->lastPattern == *_pattern) {
+                    return logger;
+                }
+                std::lock_guard<std::mutex> lock(applied.mutex);
+                if (applied.pattern != *_pattern) {
+                    applied.pattern.assign(_pattern->data(), _pattern->size());
+                    logger->set_pattern(applied.pattern);
+                    applied.generation.fetch_add(1, std::memory_order_release);
+                }
+                entry->lastPattern = applied.pattern;
+                entry->generation = applied.generation.load(std::memory_order_relaxed);
+            }
+            return logger;
+        }
+    } // namespace detail
+
     /**
+ * Асинхронный режим свободных функций логирования (infoLogToFile, warnLogToRotatingFile и т.д.):
+ * запись в файлы и ротация выполняются в одном общем пуле потоков, у каждого файла остается свой приемник.
+ * Действует на логгеры, созданные после вызова, поэтому вызывается до первой записи.
+ * Повторный вызов пул не меняет.
+ *
+ * @param _config Настройки пула потоков (или готовый общий пул threadPool) и политика переполнения очереди,
+ * имя не используется.
+ * @example
+    util::log::enableAsyncFreeLogging({.queueSize = 65536});<br>
+    util::log::infoLogToFile(std::string("started"));<br>
+ */
+    inline void enableAsyncFreeLogging(const AsyncLoggerConfig &_config = {}) {
+        auto &settings = detail::freeLogSettings();
+        std::lock_guard<std::mutex> lock(settings.mutex);
+        if (settings.threadPool) {
+            return;
+        }
+        settings.threadPool = _config.threadPool;
+        if (!settings.threadPool) {
+            settings.threadPool = std::make_shared<spdlog::details::thread_pool>(_config.queueSize,
+                                                                                 _config.threadCount,
+                                                                                 _config.queueType,
+                                                                                 _config.priorityQueueSize,
+                                                                                 _config.waitStrategy,
+                                                                                 _config.perThreadQueueSize);
+        }
+        settings.overflowPolicy = _config.overflowPolicy;
+        settings.infoShedWatermark = _config.infoShedWatermark;
+        settings.warnShedWatermark = _config.warnShedWatermark;
+        settings.shedReportInterval = _config.shedReportInterval;
+    }
+
+/**
+ * Запись логов функций infoLogToFile, warnLogToFile, errorLogToFile и criticalLogToFile через общий
+ * буфер: сообщение пишется в файл _filepath, если он есть среди файлов _routes, иначе, как и без
+ * routeFileLogs, в собственный файл логгера.
+ * Буфер записывается в файлы при заполнении, при flush, при записи сообщения уровня _flushLevel и выше
+ * и не реже раза в _flushInterval, одной записью на файл, так что при смешанных уровнях системных вызовов
+ * меньше, чем при отдельном файле на функцию.
+ * Действует на логгеры, созданные после вызова, поэтому вызывается до первой записи.
+ * Повторный вызов приемник не меняет.
+ *
+ * @param _routes Файл для каждого уровня, по умолчанию файлы этих функций.
+ * @param _bufferSize Размер общего буфера.
+ * @param _flushLevel Уровень, сообщения которого записываются в файл сразу (spdlog::level::off - не записываются).
+ * @param _flushInterval Наибольшее время ожидания записи в файл (ноль - без ограничения).
+ * @example
+    util::log::routeFileLogs();<br>
+ */
+    inline void routeFileLogs(const spdlog::sinks::level_routes &_routes = {
+                                      {spdlog::level::info,     "logs/InfoFileLog.log"},
+                                      {spdlog::level::warn,     "logs/WarnFileLog.log"},
+                                      {spdlog::level::err,      "logs/ErrorFileLog.log"},
+                                      {spdlog::level::critical, "logs/CriticalFileLog.log"}},
+                              std::size_t _bufferSize = spdlog::sinks::level_router::default_buffer_size,
+                              spdlog::level::level_enum _flushLevel = spdlog::level::err,
+                              std::chrono::milliseconds _flushInterval = std::chrono::seconds(1)) {
+        auto &settings = detail::freeLogSettings();
+        std::lock_guard<std::mutex> lock(settings.mutex);
+        if (settings.fileRouter) {
+            return;
+        }
+        settings.fileRouter = std::make_shared<spdlog::sinks::level_router>(_routes, true, _bufferSize);
+        settings.fileRouter->flush_on(_flushLevel);
+        settings.fileRouter->flush_every(_flushInterval);
+    }
+
+/**
  * Запись информационного лога в файл.
  * @param msg Информация для записи в лог.
  * @param _filepath Файл, в который будет произведена запись.
@@ -187,12 +518,10 @@ namespace util::log {
     template<typename T>
     inline void infoLogToFile(T &&msg, const std::string &_filepath = "logs/InfoFileLog.log",
                               const std::string &_logName = "infoLogToConsole",
-                              const std::string &_pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
-        logger->set_pattern(_pattern);
+                              std::string_view _pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ") {
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        }, &_pattern);
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -212,12 +541,10 @@ namespace util::log {
     template<typename T>
     inline void infoLogToFile(const T &&msg, const std::string &_filepath = "logs/InfoFileLog.log",
                               const std::string &_logName = "infoLogToConsole",
-                              const std::string &_pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
-        logger->set_pattern(_pattern);
+                              std::string_view _pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ") {
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        }, &_pattern);
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -234,10 +561,9 @@ namespace util::log {
  */
     template<typename T>
     inline void infoLogToConsole(const T &&msg, const std::string &_logName = "infoLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -254,10 +580,9 @@ namespace util::log {
  */
     template<typename T>
     inline void infoLogToConsole(T &&msg, const std::string &_logName = "infoLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -279,14 +604,12 @@ namespace util::log {
     template<typename T>
     inline void infoLogToRotatingFile(const T &&msg, const std::string &_filepath = "logs/InfoRotatingLog.log",
                                       const std::string &_logName = "infoLogToRotatingFile",
-                                      const std::string &_pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ",
+                                      std::string_view _pattern = "[%D %H:%M:%S:%f][%n][%^%L%$] : %v ",
                                       std::uint32_t max_size = 1048576 * 5,
                                       std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
-        logger->set_pattern(_pattern);
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        }, &_pattern);
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -310,10 +633,9 @@ namespace util::log {
                                       const std::string &_logName = "infoLogToRotatingFile",
                                       std::uint32_t max_size = 1048576 * 5,
                                       std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->info(std::forward<decltype(msg)>(msg));
     }
 
@@ -333,10 +655,9 @@ namespace util::log {
     template<typename T>
     inline void errorLogToFile(const T &&msg, const std::string &_filepath = "logs/ErrorFileLog.log",
                                const std::string &_logName = "errorLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -356,10 +677,9 @@ namespace util::log {
     template<typename T>
     inline void errorLogToFile(T &&msg, const std::string &_filepath = "logs/ErrorFileLog.log",
                                const std::string &_logName = "errorLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -376,10 +696,9 @@ namespace util::log {
  */
     template<typename T>
     inline void errorLogToConsole(const T &&msg, const std::string &_logName = "errorLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -396,10 +715,9 @@ namespace util::log {
  */
     template<typename T>
     inline void errorLogToConsole(T &&msg, const std::string &_logName = "errorLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -423,10 +741,9 @@ namespace util::log {
                                        const std::string &_logName = "errorLogToRotatingFile",
                                        std::uint32_t max_size = 1048576 * 5,
                                        std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -450,10 +767,9 @@ namespace util::log {
                                        const std::string &_logName = "errorLogToRotatingFile",
                                        std::uint32_t max_size = 1048576 * 5,
                                        std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->error(std::forward<decltype(msg)>(msg));
     }
 
@@ -473,10 +789,9 @@ namespace util::log {
     template<typename T>
     inline void warnLogToFile(const T &&msg, const std::string &_filepath = "logs/WarnFileLog.log",
                               const std::string &_logName = "warnLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -496,10 +811,9 @@ namespace util::log {
     template<typename T>
     inline void warnLogToFile(T &&msg, const std::string &_filepath = "logs/WarnFileLog.log",
                               const std::string &_logName = "warnLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -516,10 +830,9 @@ namespace util::log {
  */
     template<typename T>
     inline void warnLogToConsole(const T &&msg, const std::string &_logName = "warnLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -536,10 +849,9 @@ namespace util::log {
  */
     template<typename T>
     inline void warnLogToConsole(T &&msg, const std::string &_logName = "warnLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -563,10 +875,9 @@ namespace util::log {
                                       const std::string &_logName = "warnLogToRotatingFile",
                                       std::uint32_t max_size = 1048576 * 5,
                                       std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -590,10 +901,9 @@ namespace util::log {
                                       const std::string &_logName = "warnLogToRotatingFile",
                                       std::uint32_t max_size = 1048576 * 5,
                                       std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->warn(std::forward<decltype(msg)>(msg));
     }
 
@@ -613,10 +923,9 @@ namespace util::log {
     template<typename T>
     inline void criticalLogToFile(const T &&msg, const std::string &_filepath = "logs/CriticalFileLog.log",
                                   const std::string &_logName = "criticalLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
@@ -636,10 +945,9 @@ namespace util::log {
     template<typename T>
     inline void criticalLogToFile(T &&msg, const std::string &_filepath = "logs/CriticalFileLog.log",
                                   const std::string &_logName = "criticalLogToFile") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::basic_logger_mt(_logName, _filepath, true);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::basic_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, true);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
@@ -656,10 +964,9 @@ namespace util::log {
  */
     template<typename T>
     inline void criticalLogToConsole(const T &&msg, const std::string &_logName = "criticalLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
@@ -676,10 +983,9 @@ namespace util::log {
  */
     template<typename T>
     inline void criticalLogToConsole(T &&msg, const std::string &_logName = "criticalLogToConsole") {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::stdout_color_mt(_logName);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return detail::FreeLoggerFactory::create<spdlog::sinks::stdout_color_sink_mt>(_logName);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
@@ -703,10 +1009,9 @@ namespace util::log {
                                           const std::string &_logName = "criticalLogToRotatingFile",
                                           std::uint32_t max_size = 1048576 * 5,
                                           std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
@@ -730,10 +1035,9 @@ namespace util::log {
                                           const std::string &_logName = "criticalLogToRotatingFile",
                                           std::uint32_t max_size = 1048576 * 5,
                                           std::uint32_t max_files = 3) {
-        std::shared_ptr<spdlog::logger> logger{spdlog::get(_logName)};
-        if (!logger) {
-            logger = spdlog::rotating_logger_mt(_logName, _filepath, max_size, max_files);
-        }
+        auto logger = detail::cachedLogger(_logName, [&] {
+            return spdlog::rotating_logger_mt<detail::FreeLoggerFactory>(_logName, _filepath, max_size, max_files);
+        });
         logger->critical(std::forward<decltype(msg)>(msg));
     }
 
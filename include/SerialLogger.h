@@ -4,9 +4,415 @@
 
 #ifndef BOOST_LOG_SERIALLOGGER_H
 #define BOOST_LOG_SERIALLOGGER_H
+#include <iterator>
+#include <memory>
+
+#include "spdlog/logger.h"
+#include "spdlog/details/deferred_args.h"
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/fmt/bin_to_hex.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/spdlog.h"
+
+#include "AsyncLogger.h"
 
 namespace util::log {
+    namespace detail {
+        /**
+         * Синхронный логгер одного потока: аргументы форматируются в заранее выделенный буфер текста,
+         * сообщение - один раз в заранее выделенный буфер и передается готовым всем приемникам
+         * с тем же форматом.
+         */
+        class SerialSpdLogger final : public spdlog::logger {
+        public:
+            SerialSpdLogger(std::string _name, const std::vector<spdlog::sink_ptr> &_sinks, std::size_t _bufferSize) :
+                    spdlog::logger(std::move(_name), _sinks.begin(), _sinks.end()) {
+                payload.reserve(_bufferSize);
+                formatted.buf.reserve(_bufferSize);
+            }
+
+            SerialSpdLogger(const SerialSpdLogger &_other) :
+                    spdlog::logger(_other),
+                    sharedFormatter(_other.sharedFormatter ? _other.sharedFormatter->clone() : nullptr),
+                    formatterKey(_other.formatterKey) {
+                payload.reserve(_other.payload.capacity());
+                formatted.buf.reserve(_other.formatted.buf.capacity());
+            }
+
+            void set_formatter(std::unique_ptr<spdlog::formatter> _formatter) override {
+                sharedFormatter = _formatter->clone();
+                formatterKey = sharedFormatter->key();
+                spdlog::logger::set_formatter(std::move(_formatter));
+            }
+
+            std::shared_ptr<spdlog::logger> clone(std::string _name) override {
+                auto cloned = std::make_shared<SerialSpdLogger>(*this);
+                cloned->name_ = std::move(_name);
+                return cloned;
+            }
+
+            /// Запись с форматированием аргументов в буфер текста, без spdlog::logger::log и его буфера.
+            template<typename... Args>
+            void logFormatted(spdlog::level::level_enum _lvl, spdlog::string_view_t _fmt, const Args &... _args) {
+                bool logEnabled = should_log(_lvl);
+                bool tracebackEnabled = tracer_.enabled();
+                if (!logEnabled && !tracebackEnabled) {
+                    return;
+                }
+                SPDLOG_TRY
+                {
+                    payload.clear();
+                    spdlog::details::deferred_args<>::format(_fmt, nullptr, payload, _args...);
+                    logPayload(_lvl, logEnabled, tracebackEnabled);
+                }
+                SPDLOG_LOGGER_CATCH(spdlog::source_loc{})
+            }
+
+            /// Шестнадцатеричный дамп _size байт по адресу _data, как log(_lvl, "{}", to_hex(...)).
+            void logHex(spdlog::level::level_enum _lvl, const char *_data, std::size_t _size) {
+                bool logEnabled = should_log(_lvl);
+                bool tracebackEnabled = tracer_.enabled();
+                if (!logEnabled && !tracebackEnabled) {
+                    return;
+                }
+                SPDLOG_TRY
+                {
+                    payload.clear();
+                    spdlog::details::format_hex_deferred<32>("{}", spdlog::string_view_t(_data, _size), payload);
+                    logPayload(_lvl, logEnabled, tracebackEnabled);
+                }
+                SPDLOG_LOGGER_CATCH(spdlog::source_loc{})
+            }
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg &_msg) override {
+                if (!sharedFormatter) {
+                    spdlog::logger::sink_it_(_msg);
+                    return;
+                }
+                bool isFormatted = false;
+                SPDLOG_TRY
+                {
+                    formatted.buf.clear();
+                    _msg.color_range_start = 0;
+                    _msg.color_range_end = 0;
+                    sharedFormatter->format(_msg, formatted.buf);
+                    formatted.color_range_start = _msg.color_range_start;
+                    formatted.color_range_end = _msg.color_range_end;
+                    isFormatted = true;
+                }
+                SPDLOG_LOGGER_CATCH(_msg.source)
+                if (!isFormatted) {
+                    return;
+                }
+
+                for (auto &sink: sinks_) {
+                    if (sink->should_log(_msg.level)) {
+                        SPDLOG_TRY
+                        {
+                            sink->log_formatted_batch(&_msg, &formatted, 1, formatterKey);
+                        }
+                        SPDLOG_LOGGER_CATCH(_msg.source)
+                    }
+                }
+
+                if (should_flush_(_msg)) {
+                    flush_();
+                }
+            }
+
+        private:
+            void logPayload(spdlog::level::level_enum _lvl, bool _logEnabled, bool _tracebackEnabled) {
+                spdlog::details::log_msg msg(name_, _lvl, spdlog::string_view_t(payload.data(), payload.size()));
+                log_it_(msg, _logEnabled, _tracebackEnabled);
+            }
+
+            /// Буфер текста сообщения, сохраняет емкость между сообщениями.
+            spdlog::memory_buf_t payload;
+            /// Форматтер, заданный последним, и его ключ (см. spdlog::formatter::key()).
+            std::unique_ptr<spdlog::formatter> sharedFormatter;
+            std::string formatterKey;
+            /// Буфер форматирования, сохраняет емкость между сообщениями.
+            spdlog::details::formatted_msg formatted;
+        };
+    } // namespace detail
+
+    /**
+     * Синхронный логгер для одного потока (например, закрепленного за ядром): запись выполняется
+     * в вызывающем потоке, без очереди и без блокировок - приемники с spdlog::details::null_mutex.
+     * Сообщение форматируется один раз в заранее выделенный буфер, так что в установившемся режиме
+     * запись не выделяет память. API тот же, что у AsyncLogger.
+     *
+     * Логгер не регистрируется в реестре spdlog: spdlog::flush_every, apply_all, set_level и shutdown
+     * обращались бы к его приемникам из других потоков.
+     *
+     * @warning Экземпляр можно использовать только из одного потока.
+     * @example
+        Logger<SerialLogger> log;<br>
+        log.info("Order {} filled in {} us", id, elapsed);<br>
+     */
     class SerialLogger {
+    private:
+        //5 MB
+        uint32_t MAX_LOG_FILE_SIZE = 1048576 * 5;
+        uint32_t MAX_LOG_FILE_NUMBER = 10;
+        /// Начальная емкость буфера форматирования.
+        static constexpr std::size_t FORMAT_BUFFER_SIZE = 4096;
+
+    public:
+        /// Строка формата info(fmt, args...) и подобных: сообщение форматируется сразу, подходит любая строка.
+        template<typename... Args>
+        using FormatString = spdlog::format_string_t<Args...>;
+
+        /**
+         * @param _name Имя логгера.
+         */
+        explicit SerialLogger(const std::string &_name = "SerialLogger") :
+                consoleSink(std::make_shared<spdlog::sinks::stdout_color_sink_st>()),
+                rotateFileSink(std::make_shared<spdlog::sinks::rotating_file_sink_st>("logs/InfoLog.log",
+                                                                                      SerialLogger::MAX_LOG_FILE_SIZE,
+                                                                                      SerialLogger::MAX_LOG_FILE_NUMBER)),
+                exceptionFileSink(std::make_shared<spdlog::sinks::basic_file_sink_st>("logs/ExceptionLog.log")),
+                sinks{consoleSink, rotateFileSink, exceptionFileSink} {
+            initLogger(_name);
+        }
+
+        SerialLogger(const std::string &_fileLogPath, std::uint16_t _fileLogFileSize, std::uint16_t _fileLogFileNumber,
+                     const std::string &_name = "SerialLogger") :
+                consoleSink(std::make_shared<spdlog::sinks::stdout_color_sink_st>()),
+                rotateFileSink(std::make_shared<spdlog::sinks::rotating_file_sink_st>(_fileLogPath, _fileLogFileSize,
+                                                                                      _fileLogFileNumber)),
+                exceptionFileSink(std::make_shared<spdlog::sinks::basic_file_sink_st>("logs/ExceptionLog.log")),
+                sinks{consoleSink, rotateFileSink, exceptionFileSink} {
+            initLogger(_name);
+        }
+
+        SerialLogger(const SerialLogger &) = delete;
+
+        SerialLogger &operator=(const SerialLogger &) = delete;
+
+        void consoleSinkOff() {
+            consoleSink->set_level(spdlog::level::off); //4
+        }
+
+        void rotateFileSinkOff() {
+            rotateFileSink->set_level(spdlog::level::off); //4
+        }
+
+        void exceptionFileSinkOff() {
+            exceptionFileSink->set_level(spdlog::level::off); //7
+        }
+
+        void consoleSinkOn() {
+            consoleSink->set_level(spdlog::level::info); //4
+        }
+
+        void rotateFileSinkOn() {
+            rotateFileSink->set_level(spdlog::level::info); //4
+        }
+
+        void exceptionFileSinkOn() {
+            exceptionFileSink->set_level(spdlog::level::critical); //7
+        }
+
+        void setConsoleSinkLevel(spdlog::level::level_enum _lvl) {
+            consoleSink->set_level(_lvl); //4
+        }
+
+        void setRotateFileSinkLevel(spdlog::level::level_enum _lvl) {
+            rotateFileSink->set_level(_lvl); //4
+        }
+
+        void setExceptionFileSinkLevel(spdlog::level::level_enum _lvl) {
+            exceptionFileSink->set_level(_lvl); //7
+        }
+
+        template<typename T>
+        static inline auto toHex(const T &&msg) {
+            return spdlog::to_hex(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename T>
+        static inline auto toHex(T &&msg) {
+            return spdlog::to_hex(std::forward<decltype(msg)>(msg));
+        }
+
+        /**
+         * Шестнадцатеричный дамп буфера, такой же, как у info(toHex(buf)).
+         *
+         * @param buf Контейнер или массив однобайтовых элементов.
+         * @example log.infoHex(frame);
+         */
+        template<typename Container>
+        void infoHex(const Container &buf) {
+            logHex(spdlog::level::info, buf);
+        }
+
+        template<typename Container>
+        void warnHex(const Container &buf) {
+            logHex(spdlog::level::warn, buf);
+        }
+
+        template<typename Container>
+        void errorHex(const Container &buf) {
+            logHex(spdlog::level::err, buf);
+        }
+
+        template<typename Container>
+        void criticalHex(const Container &buf) {
+            logHex(spdlog::level::critical, buf);
+        }
+
+        template<typename T>
+        void info(const T &&msg) {
+            serialLog->info(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename T>
+        void info(T &&msg) {
+            serialLog->info(std::forward<decltype(msg)>(msg));
+        }
+
+        /**
+         * Запись с форматированием в вызывающем потоке, в заранее выделенный буфер.
+         *
+         * @param fmt Строка формата, проверяется на этапе компиляции.
+         * @param args Аргументы.
+         * @example log.info("Received {} bytes in {} us", size, elapsed);
+         */
+        template<typename Arg, typename... Args>
+        void info(spdlog::format_string_t<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            serialLog->logFormatted(spdlog::level::info, spdlog::string_view_t(fmt), arg, args...);
+        }
+
+        template<typename T>
+        void warn(const T &&msg) {
+            serialLog->warn(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename T>
+        void warn(T &&msg) {
+            serialLog->warn(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename Arg, typename... Args>
+        void warn(spdlog::format_string_t<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            serialLog->logFormatted(spdlog::level::warn, spdlog::string_view_t(fmt), arg, args...);
+        }
+
+        template<typename T>
+        void error(const T &&msg) {
+            serialLog->error(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename T>
+        void error(T &&msg) {
+            serialLog->error(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename Arg, typename... Args>
+        void error(spdlog::format_string_t<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            serialLog->logFormatted(spdlog::level::err, spdlog::string_view_t(fmt), arg, args...);
+        }
+
+        template<typename T>
+        void critical(const T &&msg) {
+            serialLog->critical(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename T>
+        void critical(T &&msg) {
+            serialLog->critical(std::forward<decltype(msg)>(msg));
+        }
+
+        template<typename Arg, typename... Args>
+        void critical(spdlog::format_string_t<Arg, Args...> fmt, const Arg &arg, const Args &... args) {
+            serialLog->logFormatted(spdlog::level::critical, spdlog::string_view_t(fmt), arg, args...);
+        }
+
+    private:
+        template<typename Container>
+        void logHex(spdlog::level::level_enum _lvl, const Container &buf) {
+            static_assert(sizeof(*std::data(buf)) == 1, "logHex: only byte buffers can be dumped");
+            serialLog->logHex(_lvl, reinterpret_cast<const char *>(std::data(buf)), std::size(buf));
+        }
+
+        /**
+         * Создание логгера.
+         */
+        void initLogger(const std::string &_name) {
+            serialLog = std::make_shared<detail::SerialSpdLogger>(_name, sinks, SerialLogger::FORMAT_BUFFER_SIZE);
+
+            consoleSink->set_level(spdlog::level::info); //4
+
+            rotateFileSink->set_level(spdlog::level::info); //4
+
+            exceptionFileSink->set_level(spdlog::level::critical); //7
+
+            serialLog->set_level(spdlog::level::info); //5
+            setFormat<DefaultFormat>();
+        }
+
+        std::shared_ptr<spdlog::sinks::sink> consoleSink;
+        std::shared_ptr<spdlog::sinks::sink> rotateFileSink;
+        std::shared_ptr<spdlog::sinks::sink> exceptionFileSink;
+
+        std::vector<spdlog::sink_ptr> sinks;
+
+        std::shared_ptr<detail::SerialSpdLogger> serialLog;
+
+        /**
+         * Формат записываемых данных.
+         * @copydoc https://spdlog.docsforge.com/v1.x/3.custom-formatting/#pattern-flags
+         */
+        std::string format{DefaultFormat::pattern()};
+    public:
+        const std::string &getFormat() const {
+            return format;
+        }
+
+        /**
+         * Установка фомрата вывода данных.
+         *
+         * @param format Форматирование выводимых данных.
+         * @example setFormat("*** [%H:%M:%S %z] [thread %t] %v ***")
+         * @copydoc https://spdlog.docsforge.com/v1.x/3.custom-formatting/#pattern-flags
+         *
+         */
+        void setFormat(std::string &&_format) {
+            SerialLogger::format = std::forward<decltype(_format)>(_format);
+            serialLog->set_pattern(SerialLogger::format);
+        }
+
+        /**
+         * Установка фомрата вывода данных.
+         *
+         * @param format Форматирование выводимых данных.
+         * @example setFormat("*** [%H:%M:%S %z] [thread %t] %v ***")
+         * @copydoc https://spdlog.docsforge.com/v1.x/3.custom-formatting/#pattern-flags
+         *
+         */
+        void setFormat(const std::string &&_format) {
+            SerialLogger::format = std::forward<decltype(_format)>(_format);
+            serialLog->set_pattern(SerialLogger::format);
+        }
+
+        /**
+         * Установка формата, разобранного на этапе компиляции.
+         *
+         * @tparam Formatter spdlog::static_pattern_formatter<...>, например DefaultFormat.
+         */
+        template<typename Formatter>
+        void setFormat() {
+            SerialLogger::format = Formatter::pattern();
+            serialLog->set_formatter(std::make_unique<Formatter>());
+        }
+
+        [[nodiscard]] const spdlog::logger &getMultiSinkLog() const {
+            return *serialLog;
+        }
 
     };
 }
@@ -7,6 +7,14 @@
 
 #include "spdlog/spdlog.h"
 #include "spdlog/pattern_formatter.h"
+#include "spdlog/static_pattern_formatter.h"
+
+namespace sp = spdlog::static_pattern;
+
+// "[%D %H:%M:%S:%f][%n][%^%L%$] : %v "
+using default_static_formatter = spdlog::static_pattern_formatter<sp::text<'['>, sp::flag<'D'>, sp::text<' '>, sp::flag<'H'>,
+    sp::text<':'>, sp::flag<'M'>, sp::text<':'>, sp::flag<'S'>, sp::text<':'>, sp::flag<'f'>, sp::text<']', '['>, sp::flag<'n'>,
+    sp::text<']', '['>, sp::flag<'^'>, sp::flag<'L'>, sp::flag<'$'>, sp::text<']', ' ', ':', ' '>, sp::flag<'v'>, sp::text<' '>>;
 
 void bench_formatter(benchmark::State &state, std::string pattern)
 {
@@ -26,6 +34,34 @@ void bench_formatter(benchmark::State &state, std::string pattern)
     }
 }
 
+template<typename Formatter>
+void bench_static_formatter(benchmark::State &state)
+{
+    auto formatter = spdlog::details::make_unique<Formatter>();
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    const char *text = "Hello. This is some message with length of 80                                   ";
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+
+    for (auto _ : state)
+    {
+        dest.clear();
+        formatter->format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// runtime vs compile time parsed default pattern
+void bench_default_pattern()
+{
+    auto pattern = default_static_formatter::pattern();
+    benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern)->Iterations(2500000);
+    benchmark::RegisterBenchmark((pattern + " (static)").c_str(), &bench_static_formatter<default_static_formatter>)
+        ->Iterations(2500000);
+}
+
 void bench_formatters()
 {
     // basic patterns(single flag)
@@ -54,6 +90,7 @@ void bench_formatters()
     {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern)->Iterations(2500000);
     }
+    bench_default_pattern();
 }
 
 int main(int argc, char *argv[])
@@ -62,7 +99,7 @@ int main(int argc, char *argv[])
     spdlog::set_pattern("[%^%l%$] %v");
     if (argc != 2)
     {
-        spdlog::error("Usage: {} <pattern> (or \"all\" to bench all)", argv[0]);
+        spdlog::error("Usage: {} <pattern> (or \"all\" to bench all, \"default\" for the default pattern)", argv[0]);
         exit(1);
     }
 
@@ -71,6 +108,10 @@ int main(int argc, char *argv[])
     {
         bench_formatters();
     }
+    else if (pattern == "default")
+    {
+        bench_default_pattern();
+    }
     else
     {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
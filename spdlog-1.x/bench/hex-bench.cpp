@@ -0,0 +1,64 @@
+//
+// Copyright(c) 2018 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+// spdlog::to_hex of a frame: vectorized dump of a contiguous range vs the generic per byte formatter
+
+#include "benchmark/benchmark.h"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/fmt/bin_to_hex.h"
+
+#include <deque>
+#include <vector>
+
+static std::vector<unsigned char> make_frame(size_t size)
+{
+    std::vector<unsigned char> frame(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        frame[i] = static_cast<unsigned char>(i * 31 + 7);
+    }
+    return frame;
+}
+
+void bench_hex_contiguous(benchmark::State &state, const char *format)
+{
+    auto frame = make_frame(static_cast<size_t>(state.range(0)));
+    spdlog::memory_buf_t dest;
+    for (auto _ : state)
+    {
+        dest.clear();
+        fmt::format_to(std::back_inserter(dest), SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(frame));
+        benchmark::DoNotOptimize(dest);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void bench_hex_generic(benchmark::State &state, const char *format)
+{
+    auto frame = make_frame(static_cast<size_t>(state.range(0)));
+    std::deque<unsigned char> deque_frame(frame.begin(), frame.end());
+    spdlog::memory_buf_t dest;
+    for (auto _ : state)
+    {
+        dest.clear();
+        fmt::format_to(std::back_inserter(dest), SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(deque_frame.begin(), deque_frame.end()));
+        benchmark::DoNotOptimize(dest);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+int main(int argc, char *argv[])
+{
+    for (auto format : {"{}", "{:X}", "{:a}", "{:sn}"})
+    {
+        benchmark::RegisterBenchmark((std::string("contiguous ") + format).c_str(), &bench_hex_contiguous, format)
+            ->Arg(64)
+            ->Arg(4096);
+        benchmark::RegisterBenchmark((std::string("generic ") + format).c_str(), &bench_hex_generic, format)->Arg(64)->Arg(4096);
+    }
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+}
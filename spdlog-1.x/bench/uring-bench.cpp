@@ -0,0 +1,81 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// uring-bench.cpp : async worker throughput with basic_file_sink vs uring_file_sink
+//
+// Run it on the disk to measure, e.g. tmpfs for the no stall baseline, or a loop
+// device throttled with the io cgroup controller to simulate a slow disk:
+//
+//   truncate -s 4G /tmp/slow.img && mkfs.ext4 -q /tmp/slow.img
+//   mkdir -p /mnt/slow && mount -o loop /tmp/slow.img /mnt/slow
+//   echo "$(lsblk -no MAJ:MIN $(losetup -j /tmp/slow.img | cut -d: -f1)) wbps=10485760" > /sys/fs/cgroup/bench/io.max
+//   echo $$ > /sys/fs/cgroup/bench/cgroup.procs && ./uring-bench /mnt/slow
+//
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/uring_file_sink.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std::chrono;
+
+// time to log howmany messages and for the worker to write them all
+template<typename MakeSink>
+double bench(const std::string &name, int howmany, MakeSink &&make_sink)
+{
+    auto start = high_resolution_clock::now();
+    {
+        auto pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+        auto logger = std::make_shared<spdlog::async_logger>(name, make_sink(), pool, spdlog::async_overflow_policy::block);
+        for (int i = 0; i < howmany; i++)
+        {
+            logger->info("Hello logger: msg number {}", i);
+        }
+        logger->flush();
+        // the pool destructor waits for the worker to write the queued messages
+    }
+    auto delta = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    spdlog::info("{:<28} Elapsed: {:0.3f} secs {:>12L}/sec", name, delta, int(howmany / delta));
+    return delta;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        spdlog::info("Usage: {} <dir> <message_count> <iterations>", argv[0]);
+        return 0;
+    }
+    std::string dir = argv[1];
+    int howmany = argc > 2 ? atoi(argv[2]) : 1000000;
+    int iters = argc > 3 ? atoi(argv[3]) : 3;
+
+    try
+    {
+        spdlog::set_pattern("[%^%l%$] %v");
+        for (int i = 0; i < iters; i++)
+        {
+            bench("basic_file_sink", howmany,
+                [&] { return std::make_shared<spdlog::sinks::basic_file_sink_mt>(dir + "/basic.log", true); });
+            bench("uring_file_sink", howmany,
+                [&] { return std::make_shared<spdlog::sinks::uring_file_sink_mt>(dir + "/uring.log", true); });
+            bench("uring_file_sink (write)", howmany,
+                [&] { return std::make_shared<spdlog::sinks::uring_file_sink_mt>(dir + "/write.log", true, 4, 64 * 1024, false); });
+        }
+    }
+    catch (std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        perror("Last error");
+        return 1;
+    }
+    return 0;
+}
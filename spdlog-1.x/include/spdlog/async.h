@@ -73,10 +73,10 @@ inline std::shared_ptr<spdlog::logger> create_async_nb(std::string logger_name,
 }
 
 // set global thread pool.
-inline void init_thread_pool(
-    size_t q_size, size_t thread_count, std::function<void()> on_thread_start, std::function<void()> on_thread_stop)
+inline void init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start,
+    std::function<void()> on_thread_stop, async_queue_type queue_type = async_queue_type::mpmc_blocking)
 {
-    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, on_thread_start, on_thread_stop);
+    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, on_thread_start, on_thread_stop, queue_type);
     details::registry::instance().set_tp(std::move(tp));
 }
 
@@ -91,6 +91,12 @@ inline void init_thread_pool(size_t q_size, size_t thread_count)
         q_size, thread_count, [] {}, [] {});
 }
 
+inline void init_thread_pool(size_t q_size, size_t thread_count, async_queue_type queue_type)
+{
+    init_thread_pool(
+        q_size, thread_count, [] {}, [] {}, queue_type);
+}
+
 // get the global thread pool.
 inline std::shared_ptr<spdlog::details::thread_pool> thread_pool()
 {
@@ -8,8 +8,11 @@
 #endif
 
 #include <spdlog/sinks/sink.h>
+#include <spdlog/details/fmt_helper.h>
 #include <spdlog/details/thread_pool.h>
+#include <spdlog/pattern_formatter.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -23,30 +26,129 @@ SPDLOG_INLINE spdlog::async_logger::async_logger(
     : async_logger(std::move(logger_name), {std::move(single_sink)}, std::move(tp), overflow_policy)
 {}
 
+SPDLOG_INLINE spdlog::async_logger::~async_logger()
+{
+    // without a pool, no worker is left to use the logger
+    details::thread_pool_pin pin(handle_.pool);
+    if (auto *pool_ptr = pin.pool())
+    {
+        SPDLOG_TRY
+        {
+            pool_ptr->release_logger(handle_.index);
+        }
+        SPDLOG_CATCH_STD
+    }
+}
+
 // send the log message to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg)
 {
-    if (auto pool_ptr = thread_pool_.lock())
+    details::thread_pool_pin pin(handle_.pool);
+    auto &pool = pool_(pin, "async log: thread pool doesn't exist anymore");
+    if (shed_(msg.level, pool))
     {
-        pool_ptr->post_log(shared_from_this(), msg, overflow_policy_);
+        return;
     }
-    else
+    pool.post_log(handle_.index, msg, overflow_policy_);
+}
+
+// send a deferred log message to the thread pool
+SPDLOG_INLINE void spdlog::async_logger::post_deferred_(
+    const details::log_msg &msg, string_view_t fmt, details::deferred_format_fn format_fn)
+{
+    details::thread_pool_pin pin(handle_.pool);
+    auto &pool = pool_(pin, "async log: thread pool doesn't exist anymore");
+    if (shed_(msg.level, pool))
     {
-        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+        return;
     }
+    pool.post_deferred_log(handle_.index, msg, fmt, format_fn, overflow_policy_);
 }
 
-// send flush request to the thread pool
-SPDLOG_INLINE void spdlog::async_logger::flush_()
+SPDLOG_INLINE void spdlog::async_logger::attach_(details::thread_pool *pool)
 {
-    if (auto pool_ptr = thread_pool_.lock())
+    if (pool == nullptr)
     {
-        pool_ptr->post_flush(shared_from_this(), overflow_policy_);
+        return;
     }
-    else
+    // only the worker takes messages out of a per thread ring, a full ring cannot drop its oldest one
+    if (overflow_policy_ == async_overflow_policy::overrun_oldest && pool->queue_type() == async_queue_type::per_thread_spsc)
+    {
+        throw_spdlog_ex("async_logger: overrun_oldest is not supported by the per_thread_spsc queue");
+    }
+    shared_format_.workers.resize(pool->worker_count());
+    handle_.index = pool->register_logger(*this);
+    handle_.pool.store(pool, std::memory_order_release);
+}
+
+SPDLOG_INLINE spdlog::details::thread_pool &spdlog::async_logger::pool_(const details::thread_pool_pin &pin, const char *what)
+{
+    auto *pool_ptr = pin.pool();
+    if (pool_ptr == nullptr || pool_ptr->closing())
+    {
+        throw_spdlog_ex(what);
+    }
+    return *pool_ptr;
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::shed_(level::level_enum lvl, details::thread_pool &pool)
+{
+    if (overflow_policy_ != async_overflow_policy::shed_by_level || lvl >= level::err)
+    {
+        return false;
+    }
+    auto &watermark = lvl == level::warn ? shed_state_.warn_watermark : shed_state_.info_watermark;
+    if (pool.queue_load() < watermark.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    shed_state_.total[lvl].fetch_add(1, std::memory_order_relaxed);
+    shed_state_.pending[lvl].fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_shed_watermarks(
+    float info_watermark, float warn_watermark, std::chrono::milliseconds report_interval)
+{
+    shed_state_.info_watermark.store(info_watermark, std::memory_order_relaxed);
+    shed_state_.warn_watermark.store(warn_watermark, std::memory_order_relaxed);
+    shed_state_.report_interval.store(report_interval.count(), std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t spdlog::async_logger::shed_counter(level::level_enum lvl) const
+{
+    return shed_state_.total[lvl].load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_shared_formatting(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(shared_format_.mutex);
+    if (enabled && !shared_format_.shared_formatter)
     {
-        throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+        // the sinks start with a default pattern formatter as well
+        shared_format_.shared_formatter = details::make_unique<pattern_formatter>();
+        shared_format_.key = shared_format_.shared_formatter->key();
+        shared_format_.generation.fetch_add(1, std::memory_order_release);
     }
+    shared_format_.enabled.store(enabled, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_formatter(std::unique_ptr<formatter> f)
+{
+    auto shared_formatter = f->clone();
+    logger::set_formatter(std::move(f));
+    // until this is done, sinks with the new formatter no longer match the key and format on their own
+    std::lock_guard<std::mutex> lock(shared_format_.mutex);
+    shared_format_.key = shared_formatter->key();
+    shared_format_.shared_formatter = std::move(shared_formatter);
+    shared_format_.generation.fetch_add(1, std::memory_order_release);
+}
+
+// send flush request to the thread pool
+SPDLOG_INLINE void spdlog::async_logger::flush_()
+{
+    details::thread_pool_pin pin(handle_.pool);
+    pool_(pin, "async flush: thread pool doesn't exist anymore").post_flush(handle_.index, overflow_policy_);
 }
 
 //
@@ -72,6 +174,192 @@ SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg
     }
 }
 
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(const details::log_msg *msgs, size_t count, size_t worker_id)
+{
+    if (shared_format_.enabled.load(std::memory_order_relaxed))
+    {
+        backend_sink_shared_(msgs, count, worker_id);
+    }
+    else
+    {
+        for (auto &sink : sinks_)
+        {
+            SPDLOG_TRY
+            {
+                sink->log_batch(msgs, count);
+            }
+            SPDLOG_LOGGER_CATCH(msgs[0].source)
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_flush_(msgs[i]))
+        {
+            backend_flush_();
+            break;
+        }
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_shared_(const details::log_msg *msgs, size_t count, size_t worker_id)
+{
+    auto &state = shared_format_.workers[worker_id];
+    if (state.generation != shared_format_.generation.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(shared_format_.mutex);
+        state.shared_formatter = shared_format_.shared_formatter ? shared_format_.shared_formatter->clone() : nullptr;
+        state.key = shared_format_.key;
+        state.generation = shared_format_.generation.load(std::memory_order_relaxed);
+    }
+    if (state.key.empty())
+    {
+        for (auto &sink : sinks_)
+        {
+            SPDLOG_TRY
+            {
+                sink->log_batch(msgs, count);
+            }
+            SPDLOG_LOGGER_CATCH(msgs[0].source)
+        }
+        return;
+    }
+
+    // render only the messages at least one sink takes, by the sink levels as of the batch start.
+    // the others are not passed to the sinks at all: a sink whose level is lowered meanwhile
+    // must not get them without their formatted text, it takes them from the next batch on.
+    auto min_level = level::off;
+    for (auto &sink : sinks_)
+    {
+        min_level = (std::min)(min_level, sink->level());
+    }
+    size_t taken_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        taken_count += msgs[i].level >= min_level ? 1 : 0;
+    }
+    if (taken_count == 0)
+    {
+        return;
+    }
+    if (taken_count < count)
+    {
+        state.taken.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (msgs[i].level >= min_level)
+            {
+                state.taken.push_back(msgs[i]);
+            }
+        }
+        msgs = state.taken.data();
+        count = taken_count;
+    }
+
+    auto &formatted = state.formatted;
+    if (formatted.size() < count)
+    {
+        formatted.resize(count);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &dest = formatted[i];
+        dest.buf.clear();
+        dest.color_range_start = 0;
+        dest.color_range_end = 0;
+        SPDLOG_TRY
+        {
+            msgs[i].color_range_start = 0;
+            msgs[i].color_range_end = 0;
+            state.shared_formatter->format(msgs[i], dest.buf);
+            dest.color_range_start = msgs[i].color_range_start;
+            dest.color_range_end = msgs[i].color_range_end;
+        }
+        SPDLOG_LOGGER_CATCH(msgs[i].source)
+    }
+
+    for (auto &sink : sinks_)
+    {
+        SPDLOG_TRY
+        {
+            sink->log_formatted_batch(msgs, formatted.data(), count, state.key);
+        }
+        SPDLOG_LOGGER_CATCH(msgs[0].source)
+    }
+}
+
+// format the arguments of a deferred message. return false if formatting failed.
+SPDLOG_INLINE bool spdlog::async_logger::backend_render_(details::async_msg &deferred_msg)
+{
+    SPDLOG_TRY
+    {
+        deferred_msg.render_deferred();
+        return true;
+    }
+    SPDLOG_LOGGER_CATCH(deferred_msg.source)
+    return false;
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_report_shed_(bool force, size_t worker_id)
+{
+    if (overflow_policy_ != async_overflow_policy::shed_by_level)
+    {
+        return;
+    }
+    bool any_pending = false;
+    for (auto &pending : shed_state_.pending)
+    {
+        any_pending = any_pending || pending.load(std::memory_order_relaxed) > 0;
+    }
+    if (!any_pending)
+    {
+        return;
+    }
+
+    auto now = details::os::now();
+    auto now_rep = now.time_since_epoch().count();
+    auto last_report = shed_state_.last_report.load(std::memory_order_relaxed);
+    if (!force)
+    {
+        auto interval = std::chrono::duration_cast<log_clock::duration>(
+            std::chrono::milliseconds(shed_state_.report_interval.load(std::memory_order_relaxed)));
+        if (now_rep - last_report < interval.count())
+        {
+            return;
+        }
+    }
+    // a concurrent worker already reports
+    if (!shed_state_.last_report.compare_exchange_strong(last_report, now_rep, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    memory_buf_t report;
+    for (int i = 0; i < level::n_levels; i++)
+    {
+        size_t count = shed_state_.pending[i].exchange(0, std::memory_order_relaxed);
+        if (count == 0)
+        {
+            continue;
+        }
+        if (report.size() > 0)
+        {
+            details::fmt_helper::append_string_view(" / ", report);
+        }
+        details::fmt_helper::append_int(count, report);
+        report.push_back(' ');
+        details::fmt_helper::append_string_view(level::to_string_view(static_cast<level::level_enum>(i)), report);
+    }
+    if (report.size() == 0)
+    {
+        return;
+    }
+    details::fmt_helper::append_string_view(" messages shed", report);
+
+    details::log_msg msg(now, source_loc{}, name_, level::warn, string_view_t(report.data(), report.size()));
+    backend_sink_batch_(&msg, 1, worker_id);
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
 {
     for (auto &sink : sinks_)
@@ -88,5 +376,8 @@ SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::s
 {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
     cloned->name_ = std::move(new_name);
+    // like a logger created after its pool, the clone of a detached logger throws when logging
+    details::thread_pool_pin pin(handle_.pool);
+    cloned->attach_(pin.pool() != nullptr && !pin.pool()->closing() ? pin.pool() : nullptr);
     return cloned;
 }
@@ -15,6 +15,17 @@
 // destructing..
 
 #include <spdlog/logger.h>
+#include <spdlog/details/deferred_args.h>
+#include <spdlog/fmt/bin_to_hex.h>
+#include <spdlog/formatter.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace spdlog {
 
@@ -22,13 +33,115 @@ namespace spdlog {
 enum class async_overflow_policy
 {
     block,         // Block until message can be enqueued
-    overrun_oldest // Discard oldest message in the queue if full when trying to
-                   // add new item.
+    overrun_oldest, // Discard oldest message in the queue if full when trying to
+                    // add new item.
+    shed_by_level   // Discard new info and lower messages above the info watermark and warn
+                    // messages above the warn watermark. Block for err and critical.
 };
 
 namespace details {
 class thread_pool;
-}
+class thread_pool_pin;
+struct async_msg;
+
+// handle of an async logger in the logger table of its thread pool.
+// queued messages refer to their logger by this handle instead of holding a shared_ptr.
+// the table is kept by the pool rather than the registry: the workers resolve the handle,
+// and each pool (e.g. one per AsyncLogger) has workers and loggers of its own.
+using async_logger_index = std::uint32_t;
+static const async_logger_index invalid_async_logger_index = static_cast<async_logger_index>(-1);
+
+// the pool the logger posts to and its handle there, registered on construction.
+// a clone has to register itself, so copying yields an unregistered handle.
+struct async_logger_handle
+{
+    // a plain pointer, so posting a message touches no shared reference count: the posting
+    // thread pins the pool instead. cleared by the pool's destructor, see thread_pool::~thread_pool().
+    std::atomic<thread_pool *> pool{nullptr};
+    async_logger_index index{invalid_async_logger_index};
+
+    async_logger_handle() = default;
+    async_logger_handle(const async_logger_handle &) {}
+    async_logger_handle &operator=(const async_logger_handle &) = delete;
+};
+
+// state of async_overflow_policy::shed_by_level.
+// copying (on logger clone) keeps the totals but not the unreported counts.
+struct async_shed_state
+{
+    std::atomic<float> info_watermark{0.75f};
+    std::atomic<float> warn_watermark{0.9f};
+    std::atomic<std::chrono::milliseconds::rep> report_interval{1000};
+    std::atomic<log_clock::rep> last_report{0};
+    std::atomic<size_t> total[level::n_levels];
+    std::atomic<size_t> pending[level::n_levels]; // not yet reported by the worker
+
+    async_shed_state()
+    {
+        for (size_t i = 0; i < level::n_levels; i++)
+        {
+            total[i].store(0, std::memory_order_relaxed);
+            pending[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    async_shed_state(const async_shed_state &other)
+        : info_watermark{other.info_watermark.load(std::memory_order_relaxed)}
+        , warn_watermark{other.warn_watermark.load(std::memory_order_relaxed)}
+        , report_interval{other.report_interval.load(std::memory_order_relaxed)}
+    {
+        for (size_t i = 0; i < level::n_levels; i++)
+        {
+            total[i].store(other.total[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            pending[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    async_shed_state &operator=(const async_shed_state &) = delete;
+};
+
+// state of the shared formatting mode (see async_logger::set_shared_formatting).
+// copying (on logger clone) clones the formatter but not the worker states.
+struct async_shared_format
+{
+    // formatter and buffers of one worker thread, so the workers of a pool
+    // format and fan out their batches without a common lock
+    struct worker_state
+    {
+        size_t generation = static_cast<size_t>(-1);
+        std::unique_ptr<formatter> shared_formatter;
+        std::string key;
+        std::vector<formatted_msg> formatted;
+        // the messages of a batch some sink takes, if the batch has others
+        std::vector<log_msg> taken;
+    };
+
+    std::atomic<bool> enabled{false};
+    // guards shared_formatter and key. a worker takes it only to clone them
+    // after a change, which bumps generation.
+    mutable std::mutex mutex;
+    std::unique_ptr<formatter> shared_formatter;
+    std::string key;
+    std::atomic<size_t> generation{0};
+    // one per worker of the pool, sized when the logger registers with it
+    std::vector<worker_state> workers;
+
+    async_shared_format() = default;
+
+    async_shared_format(const async_shared_format &other)
+        : enabled{other.enabled.load(std::memory_order_relaxed)}
+    {
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (other.shared_formatter)
+        {
+            shared_formatter = other.shared_formatter->clone();
+        }
+        key = other.key;
+    }
+
+    async_shared_format &operator=(const async_shared_format &) = delete;
+};
+} // namespace details
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>, public logger
 {
@@ -39,9 +152,10 @@ public:
     async_logger(std::string logger_name, It begin, It end, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block)
         : logger(std::move(logger_name), begin, end)
-        , thread_pool_(std::move(tp))
         , overflow_policy_(overflow_policy)
-    {}
+    {
+        attach_(tp.lock().get());
+    }
 
     async_logger(std::string logger_name, sinks_init_list sinks_list, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block);
@@ -49,17 +163,118 @@ public:
     async_logger(std::string logger_name, sink_ptr single_sink, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block);
 
+    // waits until the pool has processed the messages queued by this logger.
+    // the logger does not keep its pool alive: once the pool is being destroyed, logging throws.
+    ~async_logger() override;
+
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // async_overflow_policy::shed_by_level settings. watermarks are fractions of the queue capacity.
+    // the worker writes a "N info / M warning messages shed" record at most once per report_interval.
+    void set_shed_watermarks(float info_watermark, float warn_watermark,
+        std::chrono::milliseconds report_interval = std::chrono::milliseconds(1000));
+
+    // number of messages of the given level discarded by async_overflow_policy::shed_by_level
+    size_t shed_counter(level::level_enum lvl) const;
+
+    // format each message once on the worker and pass the result to all sinks whose formatter
+    // has the same key (see formatter::key()) as the one last set on this logger, instead of
+    // having each sink format it again. other sinks keep formatting on their own.
+    void set_shared_formatting(bool enabled);
+
+    void set_formatter(std::unique_ptr<formatter> f) override;
+
+    // Log with deferred formatting: only the format string pointer and the raw bytes of
+    // the arguments are queued, the formatting itself runs on the worker thread.
+    // Args must be arithmetic, enum or void pointer types.
+    // fmt must be a compile-time string, see basic_deferred_format_string.
+    template<typename... Args>
+    void log_deferred(level::level_enum lvl, deferred_format_string_t<Args...> fmt, const Args &... args)
+    {
+        using packer = details::deferred_args<Args...>;
+        static_assert(packer::deferrable, "log_deferred: only arithmetic, enum and void pointer arguments can be deferred");
+
+        bool log_enabled = should_log(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        if (!log_enabled && !traceback_enabled)
+        {
+            return;
+        }
+        SPDLOG_TRY
+        {
+            string_view_t fmt_view = fmt.get();
+            char packed[packer::size + 1];
+            packer::pack(packed, args...);
+            details::log_msg log_msg(name_, lvl, string_view_t(packed, packer::size));
+            if (traceback_enabled)
+            {
+                // the backtracer keeps the message text, so format it right away
+                memory_buf_t buf;
+                details::format_deferred<Args...>(fmt_view, log_msg.payload, buf);
+                log_msg.payload = string_view_t(buf.data(), buf.size());
+                log_it_(log_msg, log_enabled, traceback_enabled);
+                return;
+            }
+            post_deferred_(log_msg, fmt_view, &details::format_deferred<Args...>);
+        }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+
+    // Log a hex dump of size bytes at data with deferred formatting: only the bytes are queued,
+    // the dump is rendered on the worker thread. The output is the same as of
+    // log(lvl, fmt, to_hex(data, data + size, SizePerLine)), e.g. fmt may be "frame {:X}".
+    // fmt must stay valid until the message is processed (e.g. a string literal).
+    template<size_t SizePerLine = 32>
+    void log_hex_deferred(level::level_enum lvl, string_view_t fmt, const void *data, size_t size)
+    {
+        bool log_enabled = should_log(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        if (!log_enabled && !traceback_enabled)
+        {
+            return;
+        }
+        SPDLOG_TRY
+        {
+            details::log_msg log_msg(name_, lvl, string_view_t(static_cast<const char *>(data), size));
+            if (traceback_enabled)
+            {
+                memory_buf_t buf;
+                details::format_hex_deferred<SizePerLine>(fmt, log_msg.payload, buf);
+                log_msg.payload = string_view_t(buf.data(), buf.size());
+                log_it_(log_msg, log_enabled, traceback_enabled);
+                return;
+            }
+            post_deferred_(log_msg, fmt, &details::format_hex_deferred<SizePerLine>);
+        }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
     void flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    // worker_id is the index of the calling worker in the pool
+    void backend_sink_batch_(const details::log_msg *msgs, size_t count, size_t worker_id);
     void backend_flush_();
+    bool backend_render_(details::async_msg &deferred_msg);
+    // write the shed messages record if due (or if force is set)
+    void backend_report_shed_(bool force, size_t worker_id);
+    // format the batch with the worker's copy of the shared formatter and pass it to the sinks
+    void backend_sink_shared_(const details::log_msg *msgs, size_t count, size_t worker_id);
 
 private:
-    std::weak_ptr<details::thread_pool> thread_pool_;
+    void post_deferred_(const details::log_msg &msg, string_view_t fmt, details::deferred_format_fn format_fn);
+    // return true and count the message if shed_by_level discards it
+    bool shed_(level::level_enum lvl, details::thread_pool &pool);
+    // register with the pool's logger table (no-op without a pool)
+    void attach_(details::thread_pool *pool);
+    // the pinned pool to post to. throws if it was destroyed or is being destroyed.
+    static details::thread_pool &pool_(const details::thread_pool_pin &pin, const char *what);
+
     async_overflow_policy overflow_policy_;
+    details::async_shed_state shed_state_;
+    details::async_shared_format shared_format_;
+    details::async_logger_handle handle_;
 };
 } // namespace spdlog
 
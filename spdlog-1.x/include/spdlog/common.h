@@ -70,6 +70,15 @@
 #    endif
 #endif
 
+// consteval where the compiler supports it (fmt knows the broken ones)
+#if !defined(SPDLOG_USE_STD_FORMAT)
+#    define SPDLOG_CONSTEVAL FMT_CONSTEVAL
+#elif defined(__cpp_consteval)
+#    define SPDLOG_CONSTEVAL consteval
+#else
+#    define SPDLOG_CONSTEVAL
+#endif
+
 #if defined(__GNUC__) || defined(__clang__)
 #    define SPDLOG_DEPRECATED __attribute__((deprecated))
 #elif defined(_MSC_VER)
@@ -0,0 +1,312 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer blocking queue of variable length records.
+// Records are stored back to back in a preallocated byte ring, so queuing a
+// record never allocates and the ring memory follows the actual record sizes.
+// Each record is prefixed by its size and padded to 8 bytes. A record that does
+// not fit before the end of the ring is written at the start, and the rest of
+// the ring end is skipped.
+//
+// enqueue(..) - will block until room found to put the new record.
+// enqueue_nowait(..) - will discard the oldest records if no room left.
+// enqueue_if_have_room(..) - will return false if no room left.
+// dequeue_bulk_for(..) - will block until the queue is not empty or timeout
+// have passed, then pass up to max_records records to the reader.
+// try_dequeue_bulk(..) - same as dequeue_bulk_for(..), but never waits.
+// approx_used_bytes() - the bytes in use as of the last change, without taking the lock.
+//
+// The condition variables are only notified if a thread is actually waiting
+// on them.
+//
+// Writers and readers are called under the queue lock with a pointer into the
+// ring: writer(char *dest) must write exactly the reserved size,
+// reader(const char *data, size_t size) must copy out what it needs.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class byte_ring_queue
+{
+public:
+    explicit byte_ring_queue(size_t capacity_bytes)
+        : ring_(align_(capacity_bytes))
+    {}
+
+    byte_ring_queue(const byte_ring_queue &) = delete;
+    byte_ring_queue &operator=(const byte_ring_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    template<typename Writer>
+    void enqueue(size_t record_size, Writer &&writer)
+    {
+        size_t needed = record_bytes_(record_size);
+        bool wake_consumer = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            size_t offset = 0;
+            waiting_producers_++;
+            pop_cv_.wait(lock, [&] { return this->reserve_(needed, offset); });
+            waiting_producers_--;
+            write_(offset, needed, record_size, writer);
+            wake_consumer = waiting_consumers_ > 0;
+        }
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue immediately. discard the oldest records if no room left.
+    template<typename Writer>
+    void enqueue_nowait(size_t record_size, Writer &&writer)
+    {
+        size_t needed = record_bytes_(record_size);
+        bool wake_consumer = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            size_t offset = 0;
+            while (!reserve_(needed, offset))
+            {
+                pop_([](const char *, size_t) {});
+                overrun_counter_++;
+            }
+            write_(offset, needed, record_size, writer);
+            wake_consumer = waiting_consumers_ > 0;
+        }
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue only if there is room left. Return true, if succeeded
+    template<typename Writer>
+    bool enqueue_if_have_room(size_t record_size, Writer &&writer)
+    {
+        size_t needed = record_bytes_(record_size);
+        bool wake_consumer = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            size_t offset = 0;
+            if (!reserve_(needed, offset))
+            {
+                return false;
+            }
+            write_(offset, needed, record_size, writer);
+            wake_consumer = waiting_consumers_ > 0;
+        }
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // pass up to max_records records to the reader. if no record found, wait up to timeout and try again
+    // Return the number of dequeued records
+    template<typename Reader>
+    size_t dequeue_bulk_for(size_t max_records, std::chrono::milliseconds wait_duration, Reader &&reader)
+    {
+        size_t count = 0;
+        bool wake_producers = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            waiting_consumers_++;
+            bool ready = push_cv_.wait_for(lock, wait_duration, [this] { return this->records_ > 0; });
+            waiting_consumers_--;
+            if (!ready)
+            {
+                return 0;
+            }
+            count = pop_bulk_(max_records, reader);
+            wake_producers = waiting_producers_ > 0;
+        }
+        if (wake_producers)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
+    // pass up to max_records records to the reader without waiting. Return the number of dequeued records
+    template<typename Reader>
+    size_t try_dequeue_bulk(size_t max_records, Reader &&reader)
+    {
+        size_t count = 0;
+        bool wake_producers = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            count = pop_bulk_(max_records, reader);
+            wake_producers = count > 0 && waiting_producers_ > 0;
+        }
+        if (wake_producers)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
+    size_t overrun_counter()
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return overrun_counter_;
+    }
+
+    // number of queued records
+    size_t size()
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return records_;
+    }
+
+    // bytes in use, including record prefixes, padding and the skipped ring end
+    size_t used_bytes()
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        return used_;
+    }
+
+    // used_bytes() as of the last change, read without the lock
+    size_t approx_used_bytes() const
+    {
+        return approx_used_.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity_bytes() const
+    {
+        return ring_.size();
+    }
+
+private:
+    static const size_t record_alignment = 8;
+    // marks the rest of the ring end as unused
+    static const size_t skip_marker = static_cast<size_t>(-1);
+
+    std::mutex queue_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+    std::vector<char> ring_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    size_t used_ = 0;
+    size_t records_ = 0;
+    size_t overrun_counter_ = 0;
+    // written under queue_mutex_, so checking the fill of the queue does not take the lock
+    std::atomic<size_t> approx_used_{0};
+    // threads blocked on the condition variables
+    size_t waiting_consumers_ = 0;
+    size_t waiting_producers_ = 0;
+
+    static size_t align_(size_t n)
+    {
+        return (n + record_alignment - 1) / record_alignment * record_alignment;
+    }
+
+    size_t record_bytes_(size_t record_size) const
+    {
+        size_t needed = sizeof(size_t) + align_(record_size);
+        if (needed > ring_.size())
+        {
+            throw_spdlog_ex("byte_ring_queue: record of " + std::to_string(record_size) + " bytes does not fit in the queue");
+        }
+        return needed;
+    }
+
+    // find room for needed bytes. skip the ring end if the record does not fit there.
+    bool reserve_(size_t needed, size_t &offset)
+    {
+        if (used_ == 0)
+        {
+            head_ = tail_ = 0;
+        }
+        else if (tail_ == head_)
+        {
+            return false;
+        }
+
+        if (tail_ >= head_)
+        {
+            size_t end_room = ring_.size() - tail_;
+            if (needed <= end_room)
+            {
+                offset = tail_;
+                return true;
+            }
+            if (needed > head_)
+            {
+                return false;
+            }
+            size_t skipped = skip_marker;
+            std::memcpy(ring_.data() + tail_, &skipped, sizeof(size_t));
+            used_ += end_room;
+            tail_ = 0;
+            offset = 0;
+            return true;
+        }
+
+        if (needed > head_ - tail_)
+        {
+            return false;
+        }
+        offset = tail_;
+        return true;
+    }
+
+    template<typename Writer>
+    void write_(size_t offset, size_t needed, size_t record_size, Writer &writer)
+    {
+        std::memcpy(ring_.data() + offset, &record_size, sizeof(size_t));
+        writer(ring_.data() + offset + sizeof(size_t));
+        used_ += needed;
+        records_++;
+        tail_ = (offset + needed) % ring_.size();
+        approx_used_.store(used_, std::memory_order_relaxed);
+    }
+
+    template<typename Reader>
+    size_t pop_bulk_(size_t max_records, Reader &reader)
+    {
+        size_t count = 0;
+        while (count < max_records && records_ > 0)
+        {
+            pop_(reader);
+            count++;
+        }
+        return count;
+    }
+
+    // remove the oldest record and pass it to the reader
+    template<typename Reader>
+    void pop_(Reader &&reader)
+    {
+        size_t record_size = 0;
+        std::memcpy(&record_size, ring_.data() + head_, sizeof(size_t));
+        if (record_size == skip_marker)
+        {
+            used_ -= ring_.size() - head_;
+            head_ = 0;
+            std::memcpy(&record_size, ring_.data(), sizeof(size_t));
+        }
+        reader(static_cast<const char *>(ring_.data() + head_ + sizeof(size_t)), record_size);
+        size_t record_bytes = sizeof(size_t) + align_(record_size);
+        used_ -= record_bytes;
+        records_--;
+        head_ = (head_ + record_bytes) % ring_.size();
+        approx_used_.store(used_, std::memory_order_relaxed);
+    }
+};
+} // namespace details
+} // namespace spdlog
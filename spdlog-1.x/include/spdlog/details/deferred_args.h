@@ -0,0 +1,119 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Support for deferred formatting.
+// The caller packs the raw bytes of the format arguments, and the async worker
+// unpacks and formats them later.
+// Only types which are safe to format after the call returned are accepted:
+// arithmetic types, enums and void pointers. Other pointers and string views may
+// refer to memory that is gone by the time the worker formats the message.
+
+#include <spdlog/common.h>
+
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+// renders packed arguments with the given format string into dest
+using deferred_format_fn = void (*)(string_view_t fmt, string_view_t packed_args, memory_buf_t &dest);
+
+template<typename T>
+struct deferred_type_identity
+{
+    using type = T;
+};
+
+template<typename T>
+struct is_deferrable_arg
+    : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_same<T, const void *>::value ||
+                                       std::is_same<T, void *>::value>
+{};
+
+template<typename... Args>
+struct deferred_args;
+
+template<>
+struct deferred_args<>
+{
+    static constexpr bool deferrable = true;
+    static constexpr size_t size = 0;
+
+    static void pack(char *) {}
+
+    template<typename... Unpacked>
+    static void format(string_view_t fmt, const char *, memory_buf_t &dest, const Unpacked &... unpacked)
+    {
+#ifdef SPDLOG_USE_STD_FORMAT
+        fmt_lib::vformat_to(std::back_inserter(dest), fmt, fmt_lib::make_format_args(unpacked...));
+#else
+        fmt::detail::vformat_to(dest, fmt, fmt::make_format_args(unpacked...));
+#endif
+    }
+};
+
+template<typename T, typename... Rest>
+struct deferred_args<T, Rest...>
+{
+    static constexpr bool deferrable = is_deferrable_arg<T>::value && deferred_args<Rest...>::deferrable;
+    static constexpr size_t size = sizeof(T) + deferred_args<Rest...>::size;
+
+    // dest must have room for size bytes
+    static void pack(char *dest, const T &value, const Rest &... rest)
+    {
+        std::memcpy(dest, &value, sizeof(T));
+        deferred_args<Rest...>::pack(dest + sizeof(T), rest...);
+    }
+
+    // the packed bytes are not aligned, so each value is copied out before formatting
+    template<typename... Unpacked>
+    static void format(string_view_t fmt, const char *packed_args, memory_buf_t &dest, const Unpacked &... unpacked)
+    {
+        T value;
+        std::memcpy(&value, packed_args, sizeof(T));
+        deferred_args<Rest...>::format(fmt, packed_args + sizeof(T), dest, unpacked..., value);
+    }
+};
+
+template<typename... Args>
+void format_deferred(string_view_t fmt, string_view_t packed_args, memory_buf_t &dest)
+{
+    deferred_args<Args...>::format(fmt, packed_args.data(), dest);
+}
+
+} // namespace details
+
+// Format string of a deferred message. The worker formats the message after the call
+// returned, so only the pointer to a compile-time string (e.g. a string literal) may be
+// queued: the constructor is consteval, and runtime strings such as fmt::runtime(s) are
+// rejected. The string is checked against Args like format_string_t.
+template<typename... Args>
+class basic_deferred_format_string
+{
+public:
+    template<typename S, typename std::enable_if<std::is_convertible<const S &, string_view_t>::value, int>::type = 0>
+    SPDLOG_CONSTEVAL basic_deferred_format_string(const S &s)
+        : str_(s)
+    {
+        // checked at compile time by the format_string_t constructor
+        format_string_t<Args...> checked(s);
+        (void)checked;
+    }
+
+    string_view_t get() const
+    {
+        return str_;
+    }
+
+private:
+    string_view_t str_;
+};
+
+template<typename... Args>
+using deferred_format_string_t = basic_deferred_format_string<typename details::deferred_type_identity<Args>::type...>;
+
+} // namespace spdlog
@@ -90,6 +90,14 @@ SPDLOG_INLINE void file_helper::flush()
     }
 }
 
+SPDLOG_INLINE void file_helper::sync()
+{
+    if (fd_ != nullptr && !os::fsync_data(fd_))
+    {
+        throw_spdlog_ex("Failed sync file " + os::filename_to_str(filename_), errno);
+    }
+}
+
 SPDLOG_INLINE void file_helper::close()
 {
     if (fd_ != nullptr)
@@ -111,9 +119,12 @@ SPDLOG_INLINE void file_helper::close()
 
 SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf)
 {
-    size_t msg_size = buf.size();
-    auto data = buf.data();
-    if (std::fwrite(data, 1, msg_size, fd_) != msg_size)
+    write(buf.data(), buf.size());
+}
+
+SPDLOG_INLINE void file_helper::write(const char *data, size_t size)
+{
+    if (std::fwrite(data, 1, size, fd_) != size)
     {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
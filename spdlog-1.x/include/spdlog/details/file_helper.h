@@ -26,8 +26,11 @@ public:
     void open(const filename_t &fname, bool truncate = false);
     void reopen(bool truncate);
     void flush();
+    // force the flushed data to disk (fdatasync). call flush() first.
+    void sync();
     void close();
     void write(const memory_buf_t &buf);
+    void write(const char *data, size_t size);
     size_t size() const;
     const filename_t &filename() const;
 
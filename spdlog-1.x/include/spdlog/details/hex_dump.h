@@ -0,0 +1,421 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Hex dump of a contiguous byte range, as printed by spdlog::to_hex (see fmt/bin_to_hex.h).
+// The bytes are encoded 32 (AVX2) or 16 (SSE2) at a time, with a scalar fallback
+// for the tail and for other targets. The instruction set is picked at compile time.
+
+#include <spdlog/common.h>
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#elif defined(__SSSE3__)
+#    include <tmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define SPDLOG_HEX_SSE2
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#    define SPDLOG_HEX_SSE2
+#    define SPDLOG_HEX_SSSE3
+#endif
+
+namespace spdlog {
+namespace details {
+
+// to_hex format flags, see fmt/bin_to_hex.h
+struct hex_dump_spec
+{
+    size_t size_per_line = 32;
+    bool uppercase = false;
+    bool delimiters = true;
+    bool positions = true;
+    bool newlines = true;
+    bool ascii = false;
+};
+
+namespace hex {
+
+inline const char *digits(bool uppercase)
+{
+    return uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+}
+
+inline char *encode_scalar(const unsigned char *src, size_t n, char *out, bool uppercase)
+{
+    const char *hex_chars = digits(uppercase);
+    for (size_t i = 0; i < n; i++)
+    {
+        *out++ = hex_chars[src[i] >> 4];
+        *out++ = hex_chars[src[i] & 0x0f];
+    }
+    return out;
+}
+
+inline char *encode_spaced_scalar(const unsigned char *src, size_t n, char *out, bool uppercase)
+{
+    const char *hex_chars = digits(uppercase);
+    for (size_t i = 0; i < n; i++)
+    {
+        *out++ = hex_chars[src[i] >> 4];
+        *out++ = hex_chars[src[i] & 0x0f];
+        *out++ = ' ';
+    }
+    return out;
+}
+
+inline char printable(unsigned char ch)
+{
+    // std::isprint() in the "C" locale
+    return ch >= 0x20 && ch < 0x7f ? static_cast<char>(ch) : '.';
+}
+
+#ifdef SPDLOG_HEX_SSE2
+// nibbles (0..15) to hex digits
+inline __m128i nibbles_to_chars(__m128i nibbles, __m128i letter_offset)
+{
+    __m128i above_9 = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    __m128i chars = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+    return _mm_add_epi8(chars, _mm_and_si128(above_9, letter_offset));
+}
+
+// 16 bytes to 32 hex digits: pairs of bytes 0..7 in lo, 8..15 in hi
+inline void encode16(__m128i bytes, __m128i letter_offset, __m128i &lo, __m128i &hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i high_chars = nibbles_to_chars(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask), letter_offset);
+    __m128i low_chars = nibbles_to_chars(_mm_and_si128(bytes, mask), letter_offset);
+    lo = _mm_unpacklo_epi8(high_chars, low_chars);
+    hi = _mm_unpackhi_epi8(high_chars, low_chars);
+}
+
+inline __m128i letter_offset(bool uppercase)
+{
+    return _mm_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+}
+
+// 8 hex digit pairs to "xx xx .. xx " (24 chars)
+inline char *store_spaced8(__m128i pairs, char *out)
+{
+#    ifdef SPDLOG_HEX_SSSE3
+    const __m128i first = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i first_spaces = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m128i second = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i second_spaces = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, 0, 0, 0, 0, 0, 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_or_si128(_mm_shuffle_epi8(pairs, first), first_spaces));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm_or_si128(_mm_shuffle_epi8(pairs, second), second_spaces));
+#    else
+    alignas(16) char tmp[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(tmp), pairs);
+    for (size_t i = 0; i < 8; i++)
+    {
+        out[3 * i] = tmp[2 * i];
+        out[3 * i + 1] = tmp[2 * i + 1];
+        out[3 * i + 2] = ' ';
+    }
+#    endif
+    return out + 24;
+}
+#endif
+
+#ifdef SPDLOG_HEX_SSE2
+// the last n < 16 bytes, zero padded so they can go through the 16 byte kernels
+inline __m128i load_partial(const unsigned char *src, size_t n)
+{
+    alignas(16) unsigned char tmp[16] = {};
+    std::memcpy(tmp, src, n);
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(tmp));
+}
+#endif
+
+// n bytes to 2 * n hex digits
+inline char *encode(const unsigned char *src, size_t n, char *out, bool uppercase)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    const __m256i letters = _mm256_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask);
+        __m256i low = _mm256_and_si256(bytes, mask);
+        high = _mm256_add_epi8(_mm256_add_epi8(high, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(high, nine), letters));
+        low = _mm256_add_epi8(_mm256_add_epi8(low, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(low, nine), letters));
+        // unpack works within 128 bit lanes: [0..7 | 16..23] and [8..15 | 24..31]
+        __m256i pairs_lo = _mm256_unpacklo_epi8(high, low);
+        __m256i pairs_hi = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permute2x128_si256(pairs_lo, pairs_hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32), _mm256_permute2x128_si256(pairs_lo, pairs_hi, 0x31));
+        out += 64;
+    }
+#endif
+#ifdef SPDLOG_HEX_SSE2
+    const __m128i letters128 = letter_offset(uppercase);
+    __m128i lo, hi;
+    for (; i + 16 <= n; i += 16)
+    {
+        encode16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), letters128, lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), hi);
+        out += 32;
+    }
+    if (i < n)
+    {
+        alignas(16) char tmp[32];
+        encode16(load_partial(src + i, n - i), letters128, lo, hi);
+        _mm_store_si128(reinterpret_cast<__m128i *>(tmp), lo);
+        _mm_store_si128(reinterpret_cast<__m128i *>(tmp + 16), hi);
+        std::memcpy(out, tmp, 2 * (n - i));
+        return out + 2 * (n - i);
+    }
+    return out;
+#else
+    return encode_scalar(src + i, n - i, out, uppercase);
+#endif
+}
+
+// n bytes to "xx xx .. xx" (3 * n - 1 chars)
+inline char *encode_delimited(const unsigned char *src, size_t n, char *out, bool uppercase)
+{
+    if (n == 0)
+    {
+        return out;
+    }
+#ifdef SPDLOG_HEX_SSE2
+    const __m128i letters = letter_offset(uppercase);
+    __m128i lo, hi;
+    size_t i = 0;
+    // all but the last block, which has no trailing delimiter
+    for (; n - i > 16; i += 16)
+    {
+        encode16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), letters, lo, hi);
+        out = store_spaced8(lo, out);
+        out = store_spaced8(hi, out);
+    }
+    char tmp[48];
+    if (n - i == 16)
+    {
+        encode16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), letters, lo, hi);
+        out = store_spaced8(lo, out);
+        store_spaced8(hi, tmp);
+        std::memcpy(out, tmp, 23);
+        return out + 23;
+    }
+    encode16(load_partial(src + i, n - i), letters, lo, hi);
+    store_spaced8(hi, store_spaced8(lo, tmp));
+    std::memcpy(out, tmp, 3 * (n - i) - 1);
+    return out + 3 * (n - i) - 1;
+#else
+    out = encode_spaced_scalar(src, n - 1, out, uppercase);
+    return encode_scalar(src + n - 1, 1, out, uppercase);
+#endif
+}
+
+// bytes as text, '.' for non printable ones
+inline char *ascii(const unsigned char *src, size_t n, char *out)
+{
+    size_t i = 0;
+#ifdef SPDLOG_HEX_SSE2
+    // shift 0x20..0x7e to -128..-34, so a single signed compare finds the printable ones
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(0x80 - 0x20));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(0x7f - 0x20 + 0x80));
+    const __m128i dots = _mm_set1_epi8('.');
+    for (; i < n; i += 16)
+    {
+        __m128i bytes = n - i >= 16 ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)) : load_partial(src + i, n - i);
+        __m128i printable_mask = _mm_cmplt_epi8(_mm_add_epi8(bytes, shift), limit);
+        __m128i chars = _mm_or_si128(_mm_and_si128(printable_mask, bytes), _mm_andnot_si128(printable_mask, dots));
+        if (n - i >= 16)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), chars);
+        }
+        else
+        {
+            alignas(16) char tmp[16];
+            _mm_store_si128(reinterpret_cast<__m128i *>(tmp), chars);
+            std::memcpy(out + i, tmp, n - i);
+        }
+    }
+    return out + n;
+#else
+    for (; i < n; i++)
+    {
+        *out++ = printable(src[i]);
+    }
+    return out;
+#endif
+}
+
+inline char *fill(char *out, size_t n, char ch)
+{
+    std::memset(out, ch, n);
+    return out + n;
+}
+
+inline size_t position_digits(size_t pos)
+{
+    size_t n_digits = 1;
+    for (pos >>= 4; pos != 0; pos >>= 4)
+    {
+        n_digits++;
+    }
+    return n_digits < 4 ? 4 : n_digits;
+}
+
+#ifdef _WIN32
+SPDLOG_CONSTEXPR size_t eol_size = 2;
+#else
+SPDLOG_CONSTEXPR size_t eol_size = 1;
+#endif
+
+// eol and the "{:04X}: " position header
+inline char *line_start(size_t pos, bool positions, char *out)
+{
+#ifdef _WIN32
+    *out++ = '\r';
+#endif
+    *out++ = '\n';
+    if (positions && pos <= 0xffff)
+    {
+        const char *hex_chars = digits(true);
+        out[0] = hex_chars[(pos >> 12) & 0x0f];
+        out[1] = hex_chars[(pos >> 8) & 0x0f];
+        out[2] = hex_chars[(pos >> 4) & 0x0f];
+        out[3] = hex_chars[pos & 0x0f];
+        out[4] = ':';
+        out[5] = ' ';
+        out += 6;
+    }
+    else if (positions)
+    {
+        size_t n_digits = position_digits(pos);
+        for (size_t i = n_digits; i > 0; i--)
+        {
+            out[i - 1] = digits(true)[pos & 0x0f];
+            pos >>= 4;
+        }
+        out += n_digits;
+        *out++ = ':';
+        *out++ = ' ';
+    }
+    return out;
+}
+
+inline size_t line_count(size_t n, size_t size_per_line)
+{
+    return n == 0 ? 0 : (n - 1) / size_per_line + 1;
+}
+
+// spaces before the ascii of the last line, to align it with the ones above
+inline size_t ascii_padding(size_t n, const hex_dump_spec &spec, size_t last_line_size)
+{
+    if (n > spec.size_per_line && spec.size_per_line > last_line_size)
+    {
+        return (spec.size_per_line - last_line_size) * (spec.delimiters ? 3 : 2);
+    }
+    return 0;
+}
+} // namespace hex
+
+// exact size of the hex_dump() output
+inline size_t hex_dump_size(size_t n, const hex_dump_spec &spec)
+{
+    if (!spec.newlines)
+    {
+        return spec.delimiters ? 3 * n : 2 * n;
+    }
+    size_t size_per_line = spec.size_per_line > 0 ? spec.size_per_line : 1;
+    size_t lines = hex::line_count(n, size_per_line);
+    size_t rv = spec.delimiters ? 3 * n - lines : 2 * n;
+    rv += lines * hex::eol_size;
+    if (spec.positions && lines > 0)
+    {
+        // "XXXX: " on every line, one more digit on the lines at or past each power of 16 from 0x10000
+        rv += lines * 6;
+        size_t last_pos = (lines - 1) * size_per_line;
+        for (size_t limit = 0x10000; limit != 0 && limit <= last_pos; limit = limit <= SIZE_MAX / 16 ? limit * 16 : 0)
+        {
+            size_t lines_below = (limit - 1) / size_per_line + 1;
+            rv += lines - lines_below;
+        }
+    }
+    if (spec.ascii)
+    {
+        size_t last_line_size = n - (lines > 0 ? (lines - 1) * size_per_line : 0);
+        rv += 2 * (lines > 0 ? lines : 1) + n + hex::ascii_padding(n, spec, last_line_size);
+    }
+    return rv;
+}
+
+// write the dump of [data, data + n) to out, which must have room for
+// hex_dump_size() chars. Return the end of the output.
+inline char *hex_dump(const unsigned char *data, size_t n, const hex_dump_spec &spec, char *out)
+{
+    if (!spec.newlines)
+    {
+        if (!spec.delimiters)
+        {
+            return hex::encode(data, n, out, spec.uppercase);
+        }
+        // every byte is preceded by the delimiter
+        if (n == 0)
+        {
+            return out;
+        }
+        *out++ = ' ';
+        return hex::encode_delimited(data, n, out, spec.uppercase);
+    }
+
+    size_t size_per_line = spec.size_per_line > 0 ? spec.size_per_line : 1;
+    size_t line_begin = 0;
+    for (size_t pos = 0; pos < n; pos += size_per_line)
+    {
+        if (spec.ascii && pos != 0)
+        {
+            out = hex::fill(out, 2, ' ');
+            out = hex::ascii(data + line_begin, pos - line_begin, out);
+        }
+        out = hex::line_start(pos, spec.positions, out);
+
+        size_t line_size = n - pos < size_per_line ? n - pos : size_per_line;
+        if (spec.delimiters)
+        {
+            out = hex::encode_delimited(data + pos, line_size, out, spec.uppercase);
+        }
+        else
+        {
+            out = hex::encode(data + pos, line_size, out, spec.uppercase);
+        }
+        line_begin = pos;
+    }
+
+    if (spec.ascii) // add ascii to last line
+    {
+        size_t last_line_size = n - line_begin;
+        out = hex::fill(out, hex::ascii_padding(n, spec, last_line_size) + 2, ' ');
+        out = hex::ascii(data + line_begin, last_line_size, out);
+    }
+    return out;
+}
+
+// append the dump of [data, data + n) to dest
+inline void hex_dump(const unsigned char *data, size_t n, const hex_dump_spec &spec, memory_buf_t &dest)
+{
+    size_t old_size = dest.size();
+    dest.resize(old_size + hex_dump_size(n, spec));
+    hex_dump(data, n, spec, &dest[0] + old_size);
+}
+
+} // namespace details
+} // namespace spdlog
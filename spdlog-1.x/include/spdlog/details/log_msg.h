@@ -4,6 +4,7 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <cstdint>
 #include <string>
 
 namespace spdlog {
@@ -28,6 +29,18 @@ struct SPDLOG_API log_msg
 
     source_loc source;
     string_view_t payload;
+
+    // number a sink gave the record to track it (see durable_file_sink), 0 if none
+    std::uint64_t sequence{0};
+};
+
+// a log_msg rendered by the logger, to be shared by the sinks with the same formatter.
+// keeps its own color range: sinks which format the log_msg again overwrite the one in it.
+struct formatted_msg
+{
+    memory_buf_t buf;
+    size_t color_range_start{0};
+    size_t color_range_end{0};
 };
 } // namespace details
 } // namespace spdlog
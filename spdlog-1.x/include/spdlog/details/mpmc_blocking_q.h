@@ -7,11 +7,21 @@
 // enqueue(..) - will block until room found to put the new message.
 // enqueue_nowait(..) - will return immediately with false if no room left in
 // the queue.
+// enqueue_if_have_room(..) - will return false and leave the item untouched if
+// no room left in the queue.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// dequeue_bulk_for(..) - same as dequeue_for(..), but takes up to max_items
+// messages under a single lock.
+// try_dequeue_bulk(..) - takes up to max_items messages without waiting.
+// approx_size() - the size as of the last change, without taking the lock.
+//
+// The condition variables are only notified if a thread is actually waiting
+// on them.
 
 #include <spdlog/details/circular_q.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -31,41 +41,119 @@ public:
     // try to enqueue and block if no room left
     void enqueue(T &&item)
     {
+        bool wake_consumer = false;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+            wait_for_room_(lock);
             q_.push_back(std::move(item));
+            publish_size_();
+            wake_consumer = waiting_consumers_ > 0;
+        }
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item)
     {
+        bool wake_consumer = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            q_.push_back(std::move(item));
+            publish_size_();
+            wake_consumer = waiting_consumers_ > 0;
+        }
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue only if there is room left. Return true, if succeeded
+    bool enqueue_if_have_room(T &&item)
+    {
+        bool wake_consumer = false;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (q_.full())
+            {
+                return false;
+            }
             q_.push_back(std::move(item));
+            publish_size_();
+            wake_consumer = waiting_consumers_ > 0;
         }
-        push_cv_.notify_one();
+        if (wake_consumer)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // try to dequeue item. if no item found. wait up to timeout and try again
     // Return true, if succeeded dequeue item, false otherwise
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
     {
+        bool wake_producers = false;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+            if (!wait_for_item_(lock, wait_duration))
             {
                 return false;
             }
             popped_item = std::move(q_.front());
             q_.pop_front();
+            publish_size_();
+            wake_producers = waiting_producers_ > 0;
+        }
+        if (wake_producers)
+        {
+            pop_cv_.notify_one();
         }
-        pop_cv_.notify_one();
         return true;
     }
 
+    // try to dequeue up to max_items items. if no item found. wait up to timeout and try again
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        size_t count = 0;
+        bool wake_producers = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_for_item_(lock, wait_duration))
+            {
+                return 0;
+            }
+            count = pop_bulk_(popped_items, max_items);
+            wake_producers = waiting_producers_ > 0;
+        }
+        if (wake_producers)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
+    // dequeue up to max_items items without waiting. Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        bool wake_producers = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            count = pop_bulk_(popped_items, max_items);
+            wake_producers = count > 0 && waiting_producers_ > 0;
+        }
+        if (wake_producers)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
 #else
     // apparently mingw deadlocks if the mutex is released before cv.notify_one(),
     // so release the mutex at the very end each function.
@@ -74,9 +162,13 @@ public:
     void enqueue(T &&item)
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        wait_for_room_(lock);
         q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        publish_size_();
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
@@ -84,7 +176,28 @@ public:
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        publish_size_();
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue only if there is room left. Return true, if succeeded
+    bool enqueue_if_have_room(T &&item)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full())
+        {
+            return false;
+        }
+        q_.push_back(std::move(item));
+        publish_size_();
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
     }
 
     // try to dequeue item. if no item found. wait up to timeout and try again
@@ -92,16 +205,49 @@ public:
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+        if (!wait_for_item_(lock, wait_duration))
         {
             return false;
         }
         popped_item = std::move(q_.front());
         q_.pop_front();
-        pop_cv_.notify_one();
+        publish_size_();
+        if (waiting_producers_ > 0)
+        {
+            pop_cv_.notify_one();
+        }
         return true;
     }
 
+    // try to dequeue up to max_items items. if no item found. wait up to timeout and try again
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!wait_for_item_(lock, wait_duration))
+        {
+            return 0;
+        }
+        size_t count = pop_bulk_(popped_items, max_items);
+        if (waiting_producers_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
+    // dequeue up to max_items items without waiting. Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        size_t count = pop_bulk_(popped_items, max_items);
+        if (count > 0 && waiting_producers_ > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
 #endif
 
     size_t overrun_counter()
@@ -116,11 +262,54 @@ public:
         return q_.size();
     }
 
+    // size() as of the last change, read without the lock
+    size_t approx_size() const
+    {
+        return approx_size_.load(std::memory_order_relaxed);
+    }
+
 private:
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
     spdlog::details::circular_q<T> q_;
+    // threads blocked on the condition variables. protected by queue_mutex_
+    size_t waiting_consumers_ = 0;
+    size_t waiting_producers_ = 0;
+    // written under queue_mutex_, so checking the fill of the queue does not take the lock
+    std::atomic<size_t> approx_size_{0};
+
+    void publish_size_()
+    {
+        approx_size_.store(q_.size(), std::memory_order_relaxed);
+    }
+
+    void wait_for_room_(std::unique_lock<std::mutex> &lock)
+    {
+        waiting_producers_++;
+        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        waiting_producers_--;
+    }
+
+    bool wait_for_item_(std::unique_lock<std::mutex> &lock, std::chrono::milliseconds wait_duration)
+    {
+        waiting_consumers_++;
+        bool ready = push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); });
+        waiting_consumers_--;
+        return ready;
+    }
+
+    size_t pop_bulk_(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        while (count < max_items && !q_.empty())
+        {
+            popped_items[count++] = std::move(q_.front());
+            q_.pop_front();
+        }
+        publish_size_();
+        return count;
+    }
 };
 } // namespace details
 } // namespace spdlog
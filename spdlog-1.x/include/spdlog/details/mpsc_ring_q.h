@@ -0,0 +1,267 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// lock-free bounded multi producer-single consumer queue.
+// Based on Dmitry Vyukov's bounded queue: each cell carries a sequence number
+// that tells producers and consumer whether the cell is free or holds an item.
+// enqueue(..) - will spin/yield until room found to put the new message.
+// enqueue_nowait(..) - will discard the oldest message in the queue if no room
+// left.
+// enqueue_if_have_room(..) - will return false and leave the item untouched if
+// no room left.
+// dequeue_for(..) - will block until the queue is not empty or timeout have
+// passed.
+// dequeue_bulk_for(..) - same as dequeue_for(..), but takes up to max_items
+// messages.
+// try_dequeue_bulk(..) - takes up to max_items messages without waiting.
+//
+// Producers never take a lock. The mutex below is only touched to wake up a
+// consumer that is parked in dequeue_for(..) on an empty queue.
+// The capacity is rounded up to the next power of two.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+template<typename T>
+class mpsc_ring_queue
+{
+public:
+    using item_type = T;
+    explicit mpsc_ring_queue(size_t max_items)
+        : mask_(round_up_pow2_(max_items) - 1)
+        , cells_(mask_ + 1)
+    {
+        for (size_t i = 0; i < cells_.size(); i++)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_ring_queue(const mpsc_ring_queue &) = delete;
+    mpsc_ring_queue &operator=(const mpsc_ring_queue &) = delete;
+
+    // try to enqueue and spin/yield if no room left
+    void enqueue(T &&item)
+    {
+        for (size_t attempt = 0; !try_enqueue(item); attempt++)
+        {
+            backoff_(attempt);
+        }
+        wake_consumer_();
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    void enqueue_nowait(T &&item)
+    {
+        while (!try_enqueue(item))
+        {
+            T discarded;
+            if (try_dequeue(discarded))
+            {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        wake_consumer_();
+    }
+
+    // enqueue only if there is room left. Return true, if succeeded
+    bool enqueue_if_have_room(T &&item)
+    {
+        if (!try_enqueue(item))
+        {
+            return false;
+        }
+        wake_consumer_();
+        return true;
+    }
+
+    // try to dequeue item. if no item found. wait up to timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    {
+        for (size_t attempt = 0; attempt < spin_attempts; attempt++)
+        {
+            if (try_dequeue(popped_item))
+            {
+                return true;
+            }
+            backoff_(attempt);
+        }
+
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        parked_consumers_.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in wake_consumer_(): either the producer sees us parked,
+        // or we see its item in the predicate below.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool dequeued = park_cv_.wait_for(lock, wait_duration, [this, &popped_item] { return this->try_dequeue(popped_item); });
+        parked_consumers_.fetch_sub(1, std::memory_order_relaxed);
+        return dequeued;
+    }
+
+    // wait for the first item like dequeue_for(..), then take whatever else is ready up to max_items.
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t count = 1;
+        while (count < max_items && try_dequeue(popped_items[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // dequeue up to max_items items without waiting. Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        while (count < max_items && try_dequeue(popped_items[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // move item into the queue. leave it untouched and return false if full.
+    bool try_enqueue(T &item)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell &c = cells_[pos & mask_];
+            size_t seq = c.sequence.load(std::memory_order_acquire);
+            auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (dif == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    c.data = std::move(item);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // the consumer side uses a CAS as well, so producers can discard the oldest
+    // item when overrunning (and several workers may safely share the queue).
+    bool try_dequeue(T &popped_item)
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell &c = cells_[pos & mask_];
+            size_t seq = c.sequence.load(std::memory_order_acquire);
+            auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (dif == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    popped_item = std::move(c.data);
+                    c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t overrun_counter()
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    size_t size()
+    {
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : 0;
+    }
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t spin_attempts = 64;
+
+    struct cell
+    {
+        std::atomic<size_t> sequence{0};
+        T data;
+    };
+
+    // producers and the consumer each get their own cache line
+    const size_t mask_;
+    std::vector<cell> cells_;
+    char pad0_[cache_line_size];
+    std::atomic<size_t> enqueue_pos_{0};
+    char pad1_[cache_line_size - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeue_pos_{0};
+    char pad2_[cache_line_size - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> parked_consumers_{0};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t rv = 1;
+        while (rv < n)
+        {
+            rv <<= 1;
+        }
+        return rv;
+    }
+
+    static void backoff_(size_t attempt)
+    {
+        if (attempt >= spin_attempts / 2)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // take the lock only if the consumer is actually parked
+    void wake_consumer_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_consumers_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+    }
+};
+} // namespace details
+} // namespace spdlog
@@ -259,6 +259,17 @@ SPDLOG_INLINE size_t filesize(FILE *f)
 #    pragma warning(pop)
 #endif
 
+SPDLOG_INLINE bool fsync_data(FILE *f) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return ::_commit(::_fileno(f)) == 0;
+#elif defined(__APPLE__) || defined(__OpenBSD__) || defined(_AIX)
+    return ::fsync(fileno(f)) == 0;
+#else
+    return ::fdatasync(::fileno(f)) == 0;
+#endif
+}
+
 // Return utc offset in minutes or throw spdlog_ex on failure
 SPDLOG_INLINE int utc_minutes_offset(const std::tm &tm)
 {
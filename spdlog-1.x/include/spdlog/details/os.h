@@ -61,6 +61,10 @@ SPDLOG_API bool path_exists(const filename_t &filename) SPDLOG_NOEXCEPT;
 // Return file size according to open FILE* object
 SPDLOG_API size_t filesize(FILE *f);
 
+// Force the written data of the FILE* object (already flushed from its buffer) to disk.
+// Return true on success.
+SPDLOG_API bool fsync_data(FILE *f) SPDLOG_NOEXCEPT;
+
 // Return utc offset in minutes or throw spdlog_ex on failure
 SPDLOG_API int utc_minutes_offset(const std::tm &tm = details::os::localtime());
 
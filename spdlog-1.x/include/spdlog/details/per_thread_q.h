@@ -0,0 +1,480 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// per producer thread staging queue.
+// Each producer thread lazily gets its own bounded single producer/single consumer
+// ring of max_items slots the first time it enqueues. A ring is bounded by its own
+// head and tail, so producers never write a cache line shared with other threads.
+// The single consumer merges the rings by message timestamp (T must expose a
+// "time" member). This keeps the output in chronological order, and makes
+// flush/terminate messages wait behind older messages of other threads.
+// The ring of an exited thread is reclaimed once it is drained.
+//
+// enqueue(..) - will spin/yield until room found in the caller's ring.
+// enqueue_nowait(..) - will discard the new message if the caller's ring is full:
+// only the consumer takes messages out of a ring, so the oldest cannot be dropped.
+// async_logger rejects overrun_oldest with this queue for that reason.
+// enqueue_if_have_room(..) - will return false and leave the item untouched if
+// no room left.
+// dequeue_for(..) - will block until any ring is not empty or timeout have
+// passed. Must be called from a single consumer thread only.
+// dequeue_bulk_for(..) - same as dequeue_for(..), but takes up to max_items
+// messages.
+// try_dequeue_bulk(..) - takes up to max_items messages without waiting.
+// Must be called from the consumer thread only.
+// size() sums the rings. load() is the fill of the caller's own ring.
+// The ring capacity is rounded up to the next power of two.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+// bounded single producer/single consumer ring. each side owns its index and keeps
+// a copy of the other side's, read again only when the ring looks full or empty.
+template<typename T>
+class spsc_ring
+{
+public:
+    explicit spsc_ring(size_t max_items)
+        : mask_(round_up_pow2_(max_items) - 1)
+        , slots_(mask_ + 1)
+    {}
+
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring &operator=(const spsc_ring &) = delete;
+
+    // producer only. false if the ring is full, the item is left untouched then.
+    bool try_enqueue(T &item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_copy_ > mask_)
+        {
+            head_copy_ = head_.load(std::memory_order_acquire);
+            if (tail - head_copy_ > mask_)
+            {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only
+    bool try_dequeue(T &popped_item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_copy_)
+        {
+            tail_copy_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_copy_)
+            {
+                return false;
+            }
+        }
+        popped_item = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t rv = 1;
+        while (rv < n)
+        {
+            rv <<= 1;
+        }
+        return rv;
+    }
+
+    const size_t mask_;
+    std::vector<T> slots_;
+
+    char pad0_[cache_line_size];
+    // written by the consumer
+    std::atomic<size_t> head_{0};
+    size_t tail_copy_ = 0;
+    char pad1_[cache_line_size - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    // written by the producer
+    std::atomic<size_t> tail_{0};
+    size_t head_copy_ = 0;
+    char pad2_[cache_line_size - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+template<typename T>
+class per_thread_queue
+{
+public:
+    using item_type = T;
+
+    // max_items is the capacity of the ring of each producer thread
+    explicit per_thread_queue(size_t max_items)
+        : id_(next_queue_id_())
+        , max_items_(max_items)
+    {}
+
+    per_thread_queue(const per_thread_queue &) = delete;
+    per_thread_queue &operator=(const per_thread_queue &) = delete;
+
+    ~per_thread_queue()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        for (auto &buf : buffers_)
+        {
+            buf->queue_closed.store(true, std::memory_order_release);
+        }
+    }
+
+    // try to enqueue and spin/yield if no room left
+    void enqueue(T &&item)
+    {
+        auto &ring = local_buffer_().ring;
+        for (size_t attempt = 0; !ring.try_enqueue(item); attempt++)
+        {
+            backoff_(attempt);
+        }
+        wake_consumer_();
+    }
+
+    // enqueue immediately. discard the new message if no room left.
+    void enqueue_nowait(T &&item)
+    {
+        if (!local_buffer_().ring.try_enqueue(item))
+        {
+            overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        wake_consumer_();
+    }
+
+    // enqueue only if there is room left. Return true, if succeeded
+    bool enqueue_if_have_room(T &&item)
+    {
+        if (!local_buffer_().ring.try_enqueue(item))
+        {
+            return false;
+        }
+        wake_consumer_();
+        return true;
+    }
+
+    // try to dequeue the oldest item of all rings. if no item found. wait up to timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    {
+        for (size_t attempt = 0; attempt < spin_attempts; attempt++)
+        {
+            if (pop_oldest_(popped_item))
+            {
+                return true;
+            }
+            backoff_(attempt);
+        }
+
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        consumer_parked_.store(true, std::memory_order_relaxed);
+        // pairs with the fence in wake_consumer_()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool dequeued = park_cv_.wait_for(lock, wait_duration, [this, &popped_item] { return this->pop_oldest_(popped_item); });
+        consumer_parked_.store(false, std::memory_order_relaxed);
+        return dequeued;
+    }
+
+    // wait for the first item like dequeue_for(..), then take whatever else is ready up to max_items.
+    // Return the number of dequeued items
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t count = 1;
+        while (count < max_items && pop_oldest_(popped_items[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // take up to max_items of the oldest items without waiting. Return the number of dequeued items
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        while (count < max_items && pop_oldest_(popped_items[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    size_t overrun_counter()
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    // messages in the rings and staged by the consumer
+    size_t size()
+    {
+        size_t rv = staged_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        for (auto &buf : buffers_)
+        {
+            rv += buf->ring.size();
+        }
+        return rv;
+    }
+
+    // fraction of the caller's ring in use: the room left to the caller's messages
+    float load()
+    {
+        auto *buf = find_local_buffer_();
+        return buf == nullptr ? 0.0f : static_cast<float>(buf->ring.size()) / static_cast<float>(buf->ring.capacity());
+    }
+
+    // number of producer rings currently alive
+    size_t producers()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        return buffers_.size();
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+    static constexpr size_t spin_attempts = 16;
+
+    struct buffer
+    {
+        explicit buffer(size_t max_items)
+            : ring(max_items)
+        {}
+
+        spsc_ring<T> ring;
+        std::atomic<bool> producer_exited{false};
+        std::atomic<bool> queue_closed{false};
+    };
+
+    // consumer side view of a producer ring. head holds the ring's oldest item
+    // once it was taken out for the timestamp comparison.
+    struct source
+    {
+        std::shared_ptr<buffer> buf;
+        T head;
+        bool staged = false;
+    };
+
+    // the rings owned by a producer thread, one per queue it has written to.
+    // destroyed on thread exit, which lets the consumer reclaim the rings.
+    struct thread_buffers
+    {
+        std::vector<std::pair<size_t, std::shared_ptr<buffer>>> entries;
+
+        ~thread_buffers()
+        {
+            for (auto &entry : entries)
+            {
+                entry.second->producer_exited.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    const size_t id_;
+    const size_t max_items_;
+
+    // registry of all rings. locked only when a thread registers and when a ring is reclaimed
+    std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<buffer>> buffers_;
+    std::atomic<size_t> registry_version_{0};
+
+    // consumer only state
+    std::vector<source> sources_;
+    size_t seen_version_ = 0;
+
+    // written by the consumer only, read by size()
+    std::atomic<size_t> staged_{0};
+
+    char pad0_[cache_line_size];
+    std::atomic<bool> consumer_parked_{false};
+    char pad1_[cache_line_size - sizeof(std::atomic<bool>)];
+    std::atomic<size_t> overrun_counter_{0};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+
+    static size_t next_queue_id_()
+    {
+        static std::atomic<size_t> last_id{0};
+        return ++last_id;
+    }
+
+    static void backoff_(size_t attempt)
+    {
+        if (attempt >= spin_attempts / 2)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    static thread_buffers &thread_buffers_()
+    {
+        static thread_local thread_buffers local;
+        return local;
+    }
+
+    // the caller's ring, nullptr if it did not enqueue yet
+    buffer *find_local_buffer_()
+    {
+        for (auto &entry : thread_buffers_().entries)
+        {
+            if (entry.first == id_)
+            {
+                return entry.second.get();
+            }
+        }
+        return nullptr;
+    }
+
+    buffer &local_buffer_()
+    {
+        auto *buf = find_local_buffer_();
+        return buf != nullptr ? *buf : register_buffer_(thread_buffers_());
+    }
+
+    buffer &register_buffer_(thread_buffers &local)
+    {
+        // forget the rings of queues which were destroyed meanwhile
+        local.entries.erase(std::remove_if(local.entries.begin(), local.entries.end(),
+                                [](const std::pair<size_t, std::shared_ptr<buffer>> &entry) {
+                                    return entry.second->queue_closed.load(std::memory_order_acquire);
+                                }),
+            local.entries.end());
+
+        auto buf = std::make_shared<buffer>(max_items_);
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            buffers_.push_back(buf);
+        }
+        registry_version_.fetch_add(1, std::memory_order_release);
+        local.entries.emplace_back(id_, buf);
+        return *buf;
+    }
+
+    // take the lock only if the consumer is actually parked.
+    // consumer_parked_ is written only when the consumer parks, so producers share it read only.
+    void wake_consumer_()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_parked_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+    }
+
+    // pick up rings registered since the last call
+    void refresh_sources_()
+    {
+        size_t version = registry_version_.load(std::memory_order_acquire);
+        if (version == seen_version_)
+        {
+            return;
+        }
+        seen_version_ = version;
+
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        for (auto &buf : buffers_)
+        {
+            auto known = std::find_if(sources_.begin(), sources_.end(), [&buf](const source &src) { return src.buf == buf; });
+            if (known == sources_.end())
+            {
+                source src;
+                src.buf = buf;
+                sources_.push_back(std::move(src));
+            }
+        }
+    }
+
+    // drop a drained ring of an exited thread
+    void reclaim_source_(size_t index)
+    {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            auto &buf = sources_[index].buf;
+            buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), buf), buffers_.end());
+        }
+        if (index != sources_.size() - 1)
+        {
+            sources_[index] = std::move(sources_.back());
+        }
+        sources_.pop_back();
+    }
+
+    bool pop_oldest_(T &popped_item)
+    {
+        refresh_sources_();
+
+        for (size_t i = 0; i < sources_.size();)
+        {
+            auto &src = sources_[i];
+            if (!src.staged)
+            {
+                // read the exit flag first, so an empty ring after it is empty for good
+                bool exited = src.buf->producer_exited.load(std::memory_order_acquire);
+                src.staged = src.buf->ring.try_dequeue(src.head);
+                if (src.staged)
+                {
+                    staged_.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (exited)
+                {
+                    reclaim_source_(i);
+                    continue;
+                }
+            }
+            i++;
+        }
+
+        source *oldest = nullptr;
+        for (auto &src : sources_)
+        {
+            if (src.staged && (oldest == nullptr || src.head.time < oldest->head.time))
+            {
+                oldest = &src;
+            }
+        }
+
+        if (oldest == nullptr)
+        {
+            return false;
+        }
+        popped_item = std::move(oldest->head);
+        oldest->staged = false;
+        staged_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+};
+} // namespace details
+} // namespace spdlog
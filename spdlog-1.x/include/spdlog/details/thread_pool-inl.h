@@ -13,20 +13,51 @@
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE thread_pool::thread_pool(
-    size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop)
-    : q_(q_max_items)
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start,
+    std::function<void()> on_thread_stop, async_queue_type queue_type, size_t priority_q_max_items, async_wait_strategy wait_strategy,
+    size_t thread_q_max_items)
+    : wait_strategy_(wait_strategy)
+    , queue_type_(queue_type)
 {
     if (threads_n == 0 || threads_n > 1000)
     {
         throw_spdlog_ex("spdlog::thread_pool(): invalid threads_n param (valid "
                         "range is 1-1000)");
     }
+
+    switch (queue_type)
+    {
+    case async_queue_type::mpsc_lockfree:
+        q_.reset(new async_msg_queue_impl<lockfree_q_type>(q_max_items));
+        break;
+    case async_queue_type::per_thread_spsc:
+#ifdef SPDLOG_NO_TLS
+        (void)thread_q_max_items;
+        throw_spdlog_ex("spdlog::thread_pool(): per_thread_spsc queue requires thread local storage");
+#else
+        if (threads_n != 1)
+        {
+            throw_spdlog_ex("spdlog::thread_pool(): per_thread_spsc queue supports a single worker thread only");
+        }
+        q_.reset(new async_msg_queue_impl<per_thread_q_type>(thread_q_max_items));
+        break;
+#endif
+    case async_queue_type::byte_ring:
+        q_.reset(new async_msg_byte_queue(q_max_items * default_async_record_bytes));
+        break;
+    default:
+        q_.reset(new async_msg_queue_impl<q_type>(q_max_items));
+        break;
+    }
+    if (priority_q_max_items > 0)
+    {
+        priority_q_.reset(new lockfree_q_type(priority_q_max_items));
+    }
     for (size_t i = 0; i < threads_n; i++)
     {
-        threads_.emplace_back([this, on_thread_start, on_thread_stop] {
+        threads_.emplace_back([this, i, on_thread_start, on_thread_stop] {
             on_thread_start();
-            this->thread_pool::worker_loop_();
+            this->thread_pool::worker_loop_(i);
             on_thread_stop();
         });
     }
@@ -36,16 +67,40 @@ SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std
     : thread_pool(q_max_items, threads_n, on_thread_start, [] {})
 {}
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, async_queue_type queue_type, size_t priority_q_max_items,
+    async_wait_strategy wait_strategy, size_t thread_q_max_items)
+    : thread_pool(
+          q_max_items, threads_n, [] {}, [] {}, queue_type, priority_q_max_items, wait_strategy, thread_q_max_items)
+{}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
     : thread_pool(
           q_max_items, threads_n, [] {}, [] {})
 {}
 
-// message all threads to terminate gracefully join them
+// stop taking messages, message all threads to terminate gracefully join them
 SPDLOG_INLINE thread_pool::~thread_pool()
 {
     SPDLOG_TRY
     {
+        // pairs with the pin and the closing() check of the posting threads: a thread either
+        // sees closing_ and throws, or is counted below and done posting before the terminate messages.
+        // orphans stay pinned until the workers are joined.
+        closing_.store(true, std::memory_order_seq_cst);
+        for (;;)
+        {
+            size_t orphans;
+            {
+                std::lock_guard<std::mutex> lock(loggers_mutex_);
+                orphans = orphans_;
+            }
+            if (thread_pool_pin::pinned_count(this) <= orphans)
+            {
+                break;
+            }
+            std::this_thread::yield();
+        }
+
         for (size_t i = 0; i < threads_.size(); i++)
         {
             post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
@@ -55,82 +110,592 @@ SPDLOG_INLINE thread_pool::~thread_pool()
         {
             t.join();
         }
+
+        {
+            std::lock_guard<std::mutex> lock(loggers_mutex_);
+            for (size_t i = 0; i < loggers_end_; i++)
+            {
+                if (auto *logger = entry_at_(static_cast<async_logger_index>(i)).logger.load())
+                {
+                    logger->handle_.pool.store(nullptr, std::memory_order_seq_cst);
+                }
+            }
+            joined_ = true;
+        }
+        loggers_released_cv_.notify_all();
+
+        // the orphans, and the threads which read a logger's pool before it was detached
+        while (thread_pool_pin::pinned_count(this) > 0)
+        {
+            std::this_thread::yield();
+        }
     }
     SPDLOG_CATCH_STD
 }
 
-void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy)
+SPDLOG_INLINE async_logger_index thread_pool::register_logger(async_logger &logger)
+{
+    std::lock_guard<std::mutex> lock(loggers_mutex_);
+    async_logger_index index;
+    if (!free_loggers_.empty())
+    {
+        index = free_loggers_.back();
+        free_loggers_.pop_back();
+    }
+    else
+    {
+        if (loggers_end_ == invalid_async_logger_index)
+        {
+            throw_spdlog_ex("spdlog::thread_pool: too many async loggers");
+        }
+        index = static_cast<async_logger_index>(loggers_end_++);
+        size_t chunk, offset;
+        locate_logger_(index, chunk, offset);
+        if (offset == 0)
+        {
+            logger_chunks_[chunk].reset(new async_logger_entry[logger_chunk_size << chunk]);
+        }
+    }
+    entry_at_(index).logger = &logger;
+    return index;
+}
+
+void SPDLOG_INLINE thread_pool::release_logger(async_logger_index index)
+{
+    std::unique_lock<std::mutex> lock(loggers_mutex_);
+    if (closing())
+    {
+        // the destructor may no longer wait for this thread, so release messages could come
+        // after the terminate ones. the workers process the logger's messages until they exit.
+        orphans_++;
+        loggers_released_cv_.wait(lock, [this] { return joined_; });
+        return;
+    }
+    auto &entry = entry_at_(index);
+    entry.releasing = true;
+    entry.acked.assign(threads_.size(), false);
+    entry.acks = 0;
+    size_t worker_id = worker_id_();
+    if (worker_id < threads_.size())
+    {
+        // the worker cannot pass a release message while it waits here
+        entry.acked[worker_id] = true;
+        if (++entry.acks == threads_.size())
+        {
+            entry.logger = nullptr;
+            entry.releasing = false;
+            if (entry.release_msgs == 0)
+            {
+                free_loggers_.push_back(index);
+            }
+            return;
+        }
+    }
+    size_t overruns = post_release_(index, lock);
+    while (!loggers_released_cv_.wait_for(lock, std::chrono::milliseconds(100), [&entry] { return !entry.releasing; }))
+    {
+        // overrun_oldest may have discarded release messages. the messages of the logger were older,
+        // so they are gone or taken by a worker as well, and any later release message does.
+        auto now_overruns = overrun_counter();
+        if (now_overruns != overruns)
+        {
+            overruns = post_release_(index, lock);
+        }
+    }
+}
+
+SPDLOG_INLINE size_t thread_pool::post_release_(async_logger_index index, std::unique_lock<std::mutex> &lock)
+{
+    size_t overruns = overrun_counter();
+    auto &entry = entry_at_(index);
+    // one for each worker which did not pass one yet
+    size_t count = threads_.size() - entry.acks;
+    entry.release_msgs += count;
+    lock.unlock();
+    for (size_t i = 0; i < count; i++)
+    {
+        post_async_msg_(async_msg(index, async_msg_type::release), async_overflow_policy::block);
+    }
+    lock.lock();
+    return overruns;
+}
+
+void SPDLOG_INLINE thread_pool::ack_release_(async_logger_index index, size_t worker_id)
+{
+    bool hand_back = false;
+    {
+        std::lock_guard<std::mutex> lock(loggers_mutex_);
+        auto &entry = entry_at_(index);
+        entry.release_msgs--;
+        if (entry.releasing && entry.acked[worker_id])
+        {
+            // meant for a worker which did not pass one yet
+            entry.release_msgs++;
+            hand_back = true;
+        }
+        else if (entry.releasing)
+        {
+            entry.acked[worker_id] = true;
+            if (++entry.acks == threads_.size())
+            {
+                entry.logger = nullptr;
+                entry.releasing = false;
+                loggers_released_cv_.notify_all();
+            }
+        }
+        if (!entry.releasing && entry.logger == nullptr && entry.release_msgs == 0)
+        {
+            free_loggers_.push_back(index);
+        }
+    }
+    if (hand_back)
+    {
+        // give the other workers a chance to take it before this one polls again
+        post_async_msg_(async_msg(index, async_msg_type::release), async_overflow_policy::block);
+        std::this_thread::yield();
+    }
+}
+
+SPDLOG_INLINE async_logger_entry &thread_pool::entry_at_(async_logger_index index)
+{
+    size_t chunk, offset;
+    locate_logger_(index, chunk, offset);
+    return logger_chunks_[chunk][offset];
+}
+
+void SPDLOG_INLINE thread_pool::locate_logger_(async_logger_index index, size_t &chunk, size_t &offset)
+{
+    chunk = 0;
+    offset = index;
+    while (offset >= (logger_chunk_size << chunk))
+    {
+        offset -= logger_chunk_size << chunk;
+        chunk++;
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::worker_id_() const
+{
+    auto id = std::this_thread::get_id();
+    size_t worker_id = 0;
+    while (worker_id < threads_.size() && threads_[worker_id].get_id() != id)
+    {
+        worker_id++;
+    }
+    return worker_id;
+}
+
+void SPDLOG_INLINE thread_pool::post_log(async_logger_index logger_index, const details::log_msg &msg, async_overflow_policy overflow_policy)
 {
-    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
-    post_async_msg_(std::move(async_m), overflow_policy);
+    if (priority_q_ && msg.level >= async_priority_level)
+    {
+        post_priority_msg_(async_msg(logger_index, async_msg_type::log, msg), overflow_policy);
+        return;
+    }
+    q_->enqueue_log(logger_index, msg, string_view_t{}, nullptr, overflow_policy);
+    notify_workers_();
+}
+
+void SPDLOG_INLINE thread_pool::post_deferred_log(async_logger_index logger_index, const details::log_msg &msg, string_view_t fmt,
+    deferred_format_fn format_fn, async_overflow_policy overflow_policy)
+{
+    if (priority_q_ && msg.level >= async_priority_level)
+    {
+        post_priority_msg_(async_msg(logger_index, msg, fmt, format_fn), overflow_policy);
+        return;
+    }
+    q_->enqueue_log(logger_index, msg, fmt, format_fn, overflow_policy);
+    notify_workers_();
 }
 
-void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy)
+void SPDLOG_INLINE thread_pool::post_flush(async_logger_index logger_index, async_overflow_policy overflow_policy)
 {
-    post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
+    post_async_msg_(async_msg(logger_index, async_msg_type::flush), overflow_policy);
 }
 
 size_t SPDLOG_INLINE thread_pool::overrun_counter()
 {
-    return q_.overrun_counter();
+    size_t rv = q_->overrun_counter();
+    if (priority_q_)
+    {
+        rv += priority_q_->overrun_counter();
+    }
+    return rv;
 }
 
 size_t SPDLOG_INLINE thread_pool::queue_size()
 {
-    return q_.size();
+    size_t rv = q_->size();
+    if (priority_q_)
+    {
+        rv += priority_q_->size();
+    }
+    return rv;
+}
+
+bool SPDLOG_INLINE thread_pool::has_priority_lane() const
+{
+    return priority_q_ != nullptr;
+}
+
+float SPDLOG_INLINE thread_pool::queue_load()
+{
+    return q_->load();
+}
+
+async_wait_strategy SPDLOG_INLINE thread_pool::wait_strategy() const
+{
+    return wait_strategy_;
+}
+
+async_queue_type SPDLOG_INLINE thread_pool::queue_type() const
+{
+    return queue_type_;
+}
+
+size_t SPDLOG_INLINE thread_pool::worker_count() const
+{
+    return threads_.size();
+}
+
+bool SPDLOG_INLINE thread_pool::closing() const
+{
+    return closing_.load(std::memory_order_seq_cst);
 }
 
 void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
 {
-    if (overflow_policy == async_overflow_policy::block)
+    if (overflow_policy == async_overflow_policy::overrun_oldest)
+    {
+        q_->enqueue_nowait(std::move(new_msg));
+    }
+    else
+    {
+        q_->enqueue(std::move(new_msg));
+    }
+    notify_workers_();
+}
+
+void SPDLOG_INLINE thread_pool::post_priority_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
+{
+    if (overflow_policy == async_overflow_policy::overrun_oldest)
     {
-        q_.enqueue(std::move(new_msg));
+        priority_q_->enqueue_nowait(std::move(new_msg));
     }
     else
     {
-        q_.enqueue_nowait(std::move(new_msg));
+        priority_q_->enqueue(std::move(new_msg));
+    }
+    if (wait_strategy_ == async_wait_strategy::blocking)
+    {
+        // pairs with the fence in dequeue_batch_(): either a worker about to block is counted here,
+        // or it sees the message in the priority lane and does not block.
+        // busy workers get to the priority lane after the current batch, and polling workers check it when idle.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (blocked_workers_.load(std::memory_order_relaxed) > 0 && !wakeup_posted_.exchange(true, std::memory_order_acq_rel))
+        {
+            if (!q_->enqueue_if_have_room(async_msg(async_msg_type::wakeup)))
+            {
+                wakeup_posted_.store(false, std::memory_order_release);
+            }
+        }
+    }
+    notify_workers_();
+}
+
+void SPDLOG_INLINE thread_pool::notify_workers_()
+{
+    if (wait_strategy_ == async_wait_strategy::spin_park)
+    {
+        parker_.notify();
     }
 }
 
-void SPDLOG_INLINE thread_pool::worker_loop_()
+void SPDLOG_INLINE thread_pool::worker_loop_(size_t worker_id)
 {
-    while (process_next_msg_()) {}
+    std::vector<async_msg> batch(default_async_batch_size);
+    std::vector<async_msg> priority_batch(priority_q_ ? default_async_batch_size : 0);
+    std::vector<log_msg> run;
+    run.reserve(batch.size());
+    while (process_next_batch_(worker_id, batch, priority_batch, run)) {}
 }
 
-// process next message in the queue
+// process the next batch of messages in the queue
 // return true if this thread should still be active (while no terminate msg
 // was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_()
+bool SPDLOG_INLINE thread_pool::process_next_batch_(
+    size_t worker_id, std::vector<async_msg> &batch, std::vector<async_msg> &priority_batch, std::vector<log_msg> &run)
 {
-    async_msg incoming_async_msg;
-    bool dequeued = q_.dequeue_for(incoming_async_msg, std::chrono::seconds(10));
-    if (!dequeued)
+    drain_priority_(worker_id, priority_batch, run);
+
+    size_t count = dequeue_batch_(batch, std::chrono::seconds(10));
+    size_t terminate_count = 0;
+
+    for (size_t i = 0; i < count;)
     {
-        return true;
+        auto &incoming_async_msg = batch[i];
+        switch (incoming_async_msg.msg_type)
+        {
+        case async_msg_type::log: {
+            i = sink_run_(worker_id, batch.data(), i, count, run);
+            break;
+        }
+        case async_msg_type::flush: {
+            // severe messages posted before the flush must be written by it
+            drain_priority_(worker_id, priority_batch, run);
+            auto *logger = entry_at_(incoming_async_msg.logger_index).logger.load();
+            if (logger != nullptr)
+            {
+                logger->backend_report_shed_(true, worker_id);
+                logger->backend_flush_();
+            }
+            i++;
+            break;
+        }
+
+        case async_msg_type::release: {
+            // and so must the ones posted before the release
+            drain_priority_(worker_id, priority_batch, run);
+            ack_release_(incoming_async_msg.logger_index, worker_id);
+            i++;
+            break;
+        }
+
+        case async_msg_type::terminate: {
+            terminate_count++;
+            i++;
+            break;
+        }
+
+        case async_msg_type::wakeup: {
+            // later severe messages may post a new wakeup: this one only covers the lane as drained now
+            wakeup_posted_.exchange(false, std::memory_order_acq_rel);
+            drain_priority_(worker_id, priority_batch, run);
+            i++;
+            break;
+        }
+
+        default: {
+            assert(false);
+            i++;
+        }
+        }
     }
 
-    switch (incoming_async_msg.msg_type)
+    if (terminate_count == 0)
     {
-    case async_msg_type::log: {
-        incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
         return true;
     }
-    case async_msg_type::flush: {
-        incoming_async_msg.worker_ptr->backend_flush_();
-        return true;
+    drain_priority_(worker_id, priority_batch, run);
+    // each terminate message stops one worker. hand back the ones meant for the other workers.
+    for (size_t i = 1; i < terminate_count; i++)
+    {
+        post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+    }
+    return false;
+}
+
+size_t SPDLOG_INLINE thread_pool::dequeue_batch_(std::vector<async_msg> &batch, std::chrono::milliseconds wait_duration)
+{
+    if (wait_strategy_ == async_wait_strategy::blocking)
+    {
+        blocked_workers_.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in post_priority_msg_()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t count = priority_pending_() ? q_->try_dequeue_bulk(batch.data(), batch.size())
+                                           : q_->dequeue_bulk_for(batch.data(), batch.size(), wait_duration);
+        blocked_workers_.fetch_sub(1, std::memory_order_relaxed);
+        return count;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + wait_duration;
+    for (size_t attempt = 0;; attempt++)
+    {
+        size_t count = q_->try_dequeue_bulk(batch.data(), batch.size());
+        if (count > 0 || priority_pending_())
+        {
+            return count;
+        }
+        if (attempt < spin_attempts)
+        {
+            cpu_relax();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return 0;
+        }
+        switch (wait_strategy_)
+        {
+        case async_wait_strategy::spin_park:
+            parker_.park_for(deadline - now, [this] { return this->q_->size() > 0 || this->priority_pending_(); });
+            break;
+        case async_wait_strategy::spin_yield:
+            std::this_thread::yield();
+            break;
+        default:
+            cpu_relax();
+            break;
+        }
+    }
+}
+
+bool SPDLOG_INLINE thread_pool::priority_pending_()
+{
+    return priority_q_ && priority_q_->size() > 0;
+}
+
+void SPDLOG_INLINE thread_pool::drain_priority_(size_t worker_id, std::vector<async_msg> &priority_batch, std::vector<log_msg> &run)
+{
+    if (!priority_q_)
+    {
+        return;
+    }
+    // take at most one lane's worth per call, so a flood of severe messages cannot starve the main queue
+    for (size_t taken = 0; taken < priority_q_->capacity();)
+    {
+        size_t count = 0;
+        while (count < priority_batch.size() && priority_q_->try_dequeue(priority_batch[count]))
+        {
+            count++;
+        }
+        for (size_t i = 0; i < count;)
+        {
+            i = sink_run_(worker_id, priority_batch.data(), i, count, run);
+        }
+        if (count < priority_batch.size())
+        {
+            break;
+        }
+        taken += count;
     }
+}
 
-    case async_msg_type::terminate: {
-        return false;
+size_t SPDLOG_INLINE thread_pool::sink_run_(size_t worker_id, async_msg *msgs, size_t i, size_t count, std::vector<log_msg> &run)
+{
+    auto logger_index = msgs[i].logger_index;
+    auto *logger = entry_at_(logger_index).logger.load();
+    if (logger == nullptr)
+    {
+        // released by this worker, see release_logger()
+        while (i < count && msgs[i].msg_type == async_msg_type::log && msgs[i].logger_index == logger_index)
+        {
+            i++;
+        }
+        return i;
+    }
+    logger->backend_report_shed_(false, worker_id);
+    run.clear();
+    for (; i < count && msgs[i].msg_type == async_msg_type::log && msgs[i].logger_index == logger_index; i++)
+    {
+        if (msgs[i].format_fn == nullptr || logger->backend_render_(msgs[i]))
+        {
+            run.push_back(msgs[i]);
+            run.back().logger_name = logger->name();
+        }
+    }
+    if (!run.empty())
+    {
+        logger->backend_sink_batch_(run.data(), run.size(), worker_id);
     }
+    return i;
+}
 
-    default: {
-        assert(false);
+SPDLOG_INLINE thread_pool_pin::thread_pool_pin(const std::atomic<thread_pool *> &source)
+{
+#ifdef SPDLOG_NO_TLS
+    slot_ = acquire_slot_();
+#else
+    slot_ = local_slot_();
+#endif
+    outer_ = slot_->pool.load(std::memory_order_relaxed);
+    // publish the pool, then check it is still the logger's: once the destructor detached
+    // the logger, it may already have counted the pins.
+    auto *pool = source.load(std::memory_order_acquire);
+    while (pool != nullptr)
+    {
+        slot_->pool.store(pool, std::memory_order_seq_cst);
+        auto *again = source.load(std::memory_order_seq_cst);
+        if (again == pool)
+        {
+            break;
+        }
+        pool = again;
     }
+    pool_ = pool;
+    if (pool_ == nullptr)
+    {
+        slot_->pool.store(outer_, std::memory_order_release);
     }
+}
 
-    return true;
+SPDLOG_INLINE thread_pool_pin::~thread_pool_pin()
+{
+    slot_->pool.store(outer_, std::memory_order_release);
+#ifdef SPDLOG_NO_TLS
+    release_slot_(slot_);
+#endif
 }
 
+SPDLOG_INLINE size_t thread_pool_pin::pinned_count(const thread_pool *pool)
+{
+    size_t count = 0;
+    for (auto *s = slots_().load(std::memory_order_acquire); s != nullptr; s = s->next)
+    {
+        if (s->pool.load(std::memory_order_seq_cst) == pool)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+SPDLOG_INLINE std::atomic<thread_pool_pin::slot *> &thread_pool_pin::slots_()
+{
+    static std::atomic<slot *> head{nullptr};
+    return head;
+}
+
+SPDLOG_INLINE thread_pool_pin::slot *thread_pool_pin::acquire_slot_()
+{
+    auto &head = slots_();
+    for (auto *s = head.load(std::memory_order_acquire); s != nullptr; s = s->next)
+    {
+        bool taken = false;
+        if (!s->taken.load(std::memory_order_relaxed) && s->taken.compare_exchange_strong(taken, true, std::memory_order_acquire))
+        {
+            return s;
+        }
+    }
+    auto *s = new slot();
+    s->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed)) {}
+    return s;
+}
+
+SPDLOG_INLINE void thread_pool_pin::release_slot_(slot *s)
+{
+    s->taken.store(false, std::memory_order_release);
+}
+
+#ifndef SPDLOG_NO_TLS
+SPDLOG_INLINE thread_pool_pin::slot *thread_pool_pin::local_slot_()
+{
+    // handed back to the list when the thread exits
+    struct holder
+    {
+        slot *s = acquire_slot_();
+        ~holder()
+        {
+            release_slot_(s);
+        }
+    };
+    static thread_local holder local;
+    return local.s;
+}
+#endif
+
 } // namespace details
 } // namespace spdlog
@@ -3,12 +3,20 @@
 
 #pragma once
 
+#include <spdlog/details/byte_ring_q.h>
+#include <spdlog/details/deferred_args.h>
 #include <spdlog/details/log_msg_buffer.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpsc_ring_q.h>
+#include <spdlog/details/per_thread_q.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/worker_parker.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <functional>
@@ -16,23 +24,81 @@
 namespace spdlog {
 class async_logger;
 
+// Queue implementation the thread pool uses to pass messages to its workers.
+enum class async_queue_type
+{
+    mpmc_blocking, // mutex and condition variable protected queue (default)
+    mpsc_lockfree,  // lock-free bounded ring, producers never take a lock
+    per_thread_spsc, // ring of thread_q_max_items per producer thread, merged by time (single worker, no overrun_oldest)
+    byte_ring        // variable length records in a preallocated byte ring, no allocation per message
+};
+
+// How an idle worker waits for the next message.
+// The spinning strategies trade cpu time for latency: the worker polls the queue
+// instead of sleeping in it, so producers do not have to wake it up.
+enum class async_wait_strategy
+{
+    blocking,   // sleep in the queue itself (default)
+    spin_park,  // spin, then park on a futex (Linux) or condition variable. producers wake it only while parked
+    spin_yield, // spin, then poll while yielding the cpu
+    busy_spin   // poll without ever giving up the cpu. meant for workers pinned to a dedicated core
+};
+
 namespace details {
 
 using async_logger_ptr = std::shared_ptr<spdlog::async_logger>;
 
+// max number of messages a worker takes from the queue per wakeup
+static const size_t default_async_batch_size = 64;
+
+// the byte ring queue holds q_max_items records of this average size
+static const size_t default_async_record_bytes = 128;
+
+// capacity of the ring of each producer thread with the per thread queue. the rings are
+// allocated in full by every thread which logs, so it is kept far below a usual q_max_items.
+static const size_t default_thread_q_max_items = 256;
+
+// messages of this level and above go to the priority lane, if the pool has one
+static const level::level_enum async_priority_level = level::err;
+
 enum class async_msg_type
 {
     log,
     flush,
-    terminate
+    terminate,
+    wakeup, // no-op, wakes a worker blocked on the main queue to drain the priority lane
+    release // the logger is destroyed, see thread_pool::release_logger()
+};
+
+// fixed size part of an async_msg in a byte ring queue. the payload bytes follow it.
+struct async_msg_record
+{
+    async_msg_type msg_type;
+    async_logger_index logger_index;
+    level::level_enum level;
+    log_clock::time_point time;
+    size_t thread_id;
+    std::uint64_t sequence;
+    size_t color_range_start;
+    size_t color_range_end;
+    source_loc source;
+    deferred_format_fn format_fn;
+    const char *format_data;
+    size_t format_size;
 };
 
 // Async msg to move to/from the queue
 // Movable only. should never be copied
+// The logger name is not copied into the message: the worker takes it from the logger itself.
 struct async_msg : log_msg_buffer
 {
     async_msg_type msg_type{async_msg_type::log};
-    async_logger_ptr worker_ptr;
+    async_logger_index logger_index{invalid_async_logger_index};
+
+    // set for messages logged with deferred formatting: until the worker renders it,
+    // the payload holds the packed format arguments.
+    deferred_format_fn format_fn{nullptr};
+    string_view_t format_str;
 
     async_msg() = default;
     ~async_msg() = default;
@@ -45,14 +111,18 @@ struct async_msg : log_msg_buffer
     async_msg(async_msg &&other)
         : log_msg_buffer(std::move(other))
         , msg_type(other.msg_type)
-        , worker_ptr(std::move(other.worker_ptr))
+        , logger_index(other.logger_index)
+        , format_fn(other.format_fn)
+        , format_str(other.format_str)
     {}
 
     async_msg &operator=(async_msg &&other)
     {
         *static_cast<log_msg_buffer *>(this) = std::move(other);
         msg_type = other.msg_type;
-        worker_ptr = std::move(other.worker_ptr);
+        logger_index = other.logger_index;
+        format_fn = other.format_fn;
+        format_str = other.format_str;
         return *this;
     }
 #else // (_MSC_VER) && _MSC_VER <= 1800
@@ -61,21 +131,373 @@ struct async_msg : log_msg_buffer
 #endif
 
     // construct from log_msg with given type
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m)
-        : log_msg_buffer{m}
+    async_msg(async_logger_index index, async_msg_type the_type, const details::log_msg &m)
+        : log_msg_buffer{without_name_(m)}
         , msg_type{the_type}
-        , worker_ptr{std::move(worker)}
+        , logger_index{index}
     {}
 
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type)
+    async_msg(async_logger_index index, async_msg_type the_type)
         : log_msg_buffer{}
         , msg_type{the_type}
-        , worker_ptr{std::move(worker)}
-    {}
+        , logger_index{index}
+    {
+        // stamp control messages too, so time ordered queues keep them behind older messages
+        time = os::now();
+    }
 
     explicit async_msg(async_msg_type the_type)
-        : async_msg{nullptr, the_type}
+        : async_msg{invalid_async_logger_index, the_type}
+    {}
+
+    // construct a deferred log message. m.payload holds the packed format arguments.
+    async_msg(async_logger_index index, const details::log_msg &m, string_view_t fmt, deferred_format_fn fn)
+        : log_msg_buffer{without_name_(m)}
+        , msg_type{async_msg_type::log}
+        , logger_index{index}
+        , format_fn{fn}
+        , format_str{fmt}
+    {}
+
+    // format the packed arguments of a deferred message into its payload
+    void render_deferred()
+    {
+        memory_buf_t formatted;
+        format_fn(format_str, payload, formatted);
+        format_fn = nullptr;
+        buffer.clear();
+        buffer.append(formatted.data(), formatted.data() + formatted.size());
+        payload = string_view_t{formatted.data(), formatted.size()};
+        update_string_views();
+    }
+
+    static async_msg_record make_record(
+        async_msg_type the_type, async_logger_index index, const log_msg &m, string_view_t fmt, deferred_format_fn fn)
+    {
+        async_msg_record record;
+        record.msg_type = the_type;
+        record.logger_index = index;
+        record.level = m.level;
+        record.time = m.time;
+        record.thread_id = m.thread_id;
+        record.sequence = m.sequence;
+        record.color_range_start = m.color_range_start;
+        record.color_range_end = m.color_range_end;
+        record.source = m.source;
+        record.format_fn = fn;
+        record.format_data = fmt.data();
+        record.format_size = fmt.size();
+        return record;
+    }
+
+    // overwrite with a message read back from a byte ring queue. reuses the buffer memory.
+    void assign_record(const async_msg_record &record, const char *payload_data, size_t payload_size)
+    {
+        msg_type = record.msg_type;
+        logger_index = record.logger_index;
+        logger_name = string_view_t{};
+        level = record.level;
+        time = record.time;
+        thread_id = record.thread_id;
+        sequence = record.sequence;
+        color_range_start = record.color_range_start;
+        color_range_end = record.color_range_end;
+        source = record.source;
+        format_fn = record.format_fn;
+        format_str = string_view_t{record.format_data, record.format_size};
+        buffer.clear();
+        buffer.append(payload_data, payload_data + payload_size);
+        payload = string_view_t{payload_data, payload_size};
+        update_string_views();
+    }
+
+private:
+    static log_msg without_name_(log_msg m)
+    {
+        m.logger_name = string_view_t{};
+        return m;
+    }
+};
+
+// Common interface of the queues the thread pool can post to,
+// so the implementation can be selected at runtime.
+class async_msg_queue
+{
+public:
+    virtual ~async_msg_queue() = default;
+    virtual void enqueue(async_msg &&item) = 0;
+    virtual void enqueue_nowait(async_msg &&item) = 0;
+    virtual bool enqueue_if_have_room(async_msg &&item) = 0;
+    virtual bool dequeue_for(async_msg &popped_item, std::chrono::milliseconds wait_duration) = 0;
+    virtual size_t dequeue_bulk_for(async_msg *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) = 0;
+    virtual size_t try_dequeue_bulk(async_msg *popped_items, size_t max_items) = 0;
+    virtual size_t overrun_counter() = 0;
+    virtual size_t size() = 0;
+    // fraction of the capacity in use. read without taking a queue lock, so it may lag behind.
+    virtual float load() = 0;
+
+    // queue a log message (fmt and format_fn are set for deferred messages).
+    // the default builds an async_msg, which copies the payload into its own buffer.
+    virtual void enqueue_log(async_logger_index logger_index, const log_msg &msg, string_view_t fmt, deferred_format_fn format_fn,
+        async_overflow_policy overflow_policy)
+    {
+        async_msg async_m =
+            format_fn != nullptr ? async_msg(logger_index, msg, fmt, format_fn) : async_msg(logger_index, async_msg_type::log, msg);
+        if (overflow_policy == async_overflow_policy::overrun_oldest)
+        {
+            enqueue_nowait(std::move(async_m));
+        }
+        else
+        {
+            enqueue(std::move(async_m));
+        }
+    }
+};
+
+template<typename Q>
+class async_msg_queue_impl final : public async_msg_queue
+{
+public:
+    explicit async_msg_queue_impl(size_t max_items)
+        : max_items_(max_items)
+        , q_(max_items)
+    {}
+
+    void enqueue(async_msg &&item) override
+    {
+        q_.enqueue(std::move(item));
+    }
+
+    void enqueue_nowait(async_msg &&item) override
+    {
+        q_.enqueue_nowait(std::move(item));
+    }
+
+    bool enqueue_if_have_room(async_msg &&item) override
+    {
+        return q_.enqueue_if_have_room(std::move(item));
+    }
+
+    bool dequeue_for(async_msg &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        return q_.dequeue_for(popped_item, wait_duration);
+    }
+
+    size_t dequeue_bulk_for(async_msg *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        return q_.dequeue_bulk_for(popped_items, max_items, wait_duration);
+    }
+
+    size_t try_dequeue_bulk(async_msg *popped_items, size_t max_items) override
+    {
+        return q_.try_dequeue_bulk(popped_items, max_items);
+    }
+
+    size_t overrun_counter() override
+    {
+        return q_.overrun_counter();
+    }
+
+    size_t size() override
+    {
+        return q_.size();
+    }
+
+    float load() override
+    {
+        return load_of_(q_, max_items_);
+    }
+
+private:
+    template<typename Queue>
+    static float load_of_(Queue &q, size_t max_items)
+    {
+        return max_items == 0 ? 1.0f : static_cast<float>(q.size()) / static_cast<float>(max_items);
+    }
+
+    // read without the queue lock, so shed_by_level does not lock the queue twice per message
+    template<typename U>
+    static float load_of_(mpmc_blocking_queue<U> &q, size_t max_items)
+    {
+        return max_items == 0 ? 1.0f : static_cast<float>(q.approx_size()) / static_cast<float>(max_items);
+    }
+
+    // each producer has a ring of its own: the fill that matters to the caller is its ring's
+    template<typename U>
+    static float load_of_(per_thread_queue<U> &q, size_t)
+    {
+        return q.load();
+    }
+
+    const size_t max_items_;
+    Q q_;
+};
+
+// queue of variable length records: the message fields and payload are copied
+// straight into a byte ring, and read back into the worker's reused async_msg slots.
+class async_msg_byte_queue final : public async_msg_queue
+{
+public:
+    explicit async_msg_byte_queue(size_t capacity_bytes)
+        : q_(capacity_bytes)
     {}
+
+    void enqueue(async_msg &&item) override
+    {
+        record_writer writer{record_of_(item), item.payload};
+        q_.enqueue(writer.size(), writer);
+    }
+
+    void enqueue_nowait(async_msg &&item) override
+    {
+        record_writer writer{record_of_(item), item.payload};
+        q_.enqueue_nowait(writer.size(), writer);
+    }
+
+    bool enqueue_if_have_room(async_msg &&item) override
+    {
+        record_writer writer{record_of_(item), item.payload};
+        return q_.enqueue_if_have_room(writer.size(), writer);
+    }
+
+    void enqueue_log(async_logger_index logger_index, const log_msg &msg, string_view_t fmt, deferred_format_fn format_fn,
+        async_overflow_policy overflow_policy) override
+    {
+        record_writer writer{async_msg::make_record(async_msg_type::log, logger_index, msg, fmt, format_fn), msg.payload};
+        if (overflow_policy == async_overflow_policy::overrun_oldest)
+        {
+            q_.enqueue_nowait(writer.size(), writer);
+        }
+        else
+        {
+            q_.enqueue(writer.size(), writer);
+        }
+    }
+
+    bool dequeue_for(async_msg &popped_item, std::chrono::milliseconds wait_duration) override
+    {
+        return dequeue_bulk_for(&popped_item, 1, wait_duration) == 1;
+    }
+
+    size_t dequeue_bulk_for(async_msg *popped_items, size_t max_items, std::chrono::milliseconds wait_duration) override
+    {
+        return q_.dequeue_bulk_for(max_items, wait_duration, record_reader{popped_items, 0});
+    }
+
+    size_t try_dequeue_bulk(async_msg *popped_items, size_t max_items) override
+    {
+        return q_.try_dequeue_bulk(max_items, record_reader{popped_items, 0});
+    }
+
+    size_t overrun_counter() override
+    {
+        return q_.overrun_counter();
+    }
+
+    size_t size() override
+    {
+        return q_.size();
+    }
+
+    float load() override
+    {
+        return static_cast<float>(q_.approx_used_bytes()) / static_cast<float>(q_.capacity_bytes());
+    }
+
+private:
+    struct record_writer
+    {
+        async_msg_record record;
+        string_view_t payload;
+
+        size_t size() const
+        {
+            return sizeof(record) + payload.size();
+        }
+
+        void operator()(char *dest) const
+        {
+            std::memcpy(dest, &record, sizeof(record));
+            std::memcpy(dest + sizeof(record), payload.data(), payload.size());
+        }
+    };
+
+    // reads records back into consecutive async_msg slots
+    struct record_reader
+    {
+        async_msg *popped_items;
+        size_t count;
+
+        void operator()(const char *data, size_t size)
+        {
+            async_msg_record record;
+            std::memcpy(&record, data, sizeof(record));
+            popped_items[count++].assign_record(record, data + sizeof(record), size - sizeof(record));
+        }
+    };
+
+    static async_msg_record record_of_(const async_msg &item)
+    {
+        return async_msg::make_record(item.msg_type, item.logger_index, item, item.format_str, item.format_fn);
+    }
+
+    byte_ring_queue q_;
+};
+
+// entry of the logger table. the table does not own the logger: its destructor calls
+// thread_pool::release_logger(), which returns once the workers are done with its messages.
+struct async_logger_entry
+{
+    // read by the workers without the table lock
+    std::atomic<async_logger *> logger{nullptr};
+    // release in progress: the workers which passed a release message
+    bool releasing = false;
+    std::vector<bool> acked;
+    size_t acks = 0;
+    // release messages queued and not processed yet. the index is reused once none is left.
+    size_t release_msgs = 0;
+};
+
+// keeps a thread pool from being freed while the calling thread posts to it, see ~thread_pool().
+// each thread publishes the pool it uses in a hazard slot of its own, so pinning writes
+// no cache line shared with other threads. the slots are reused but never freed.
+class SPDLOG_API thread_pool_pin
+{
+public:
+    // pin the pool source points to. pool() is null if source is null (the pool is gone).
+    explicit thread_pool_pin(const std::atomic<thread_pool *> &source);
+    ~thread_pool_pin();
+
+    thread_pool_pin(const thread_pool_pin &) = delete;
+    thread_pool_pin &operator=(const thread_pool_pin &) = delete;
+
+    thread_pool *pool() const
+    {
+        return pool_;
+    }
+
+    // number of threads pinning the pool
+    static size_t pinned_count(const thread_pool *pool);
+
+private:
+    struct slot
+    {
+        std::atomic<const thread_pool *> pool{nullptr};
+        std::atomic<bool> taken{true};
+        slot *next = nullptr;
+    };
+
+    static std::atomic<slot *> &slots_();
+    static slot *acquire_slot_();
+    static void release_slot_(slot *s);
+#ifndef SPDLOG_NO_TLS
+    static slot *local_slot_();
+#endif
+
+    slot *slot_;
+    // the pool pinned by an outer pin of the same thread, restored on destruction
+    const thread_pool *outer_;
+    thread_pool *pool_ = nullptr;
 };
 
 class SPDLOG_API thread_pool
@@ -83,34 +505,124 @@ class SPDLOG_API thread_pool
 public:
     using item_type = async_msg;
     using q_type = details::mpmc_blocking_queue<item_type>;
+    using lockfree_q_type = details::mpsc_ring_queue<item_type>;
+    using per_thread_q_type = details::per_thread_queue<item_type>;
 
-    thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop);
+    // priority_q_max_items > 0 adds a priority lane: err and critical messages are queued there
+    // and the workers always drain it before the main queue. Ordering holds within each lane only.
+    // per_thread_spsc takes thread_q_max_items instead of q_max_items: the capacity of the ring of
+    // each producer thread. the queue then holds up to producer threads * thread_q_max_items messages.
+    thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop,
+        async_queue_type queue_type = async_queue_type::mpmc_blocking, size_t priority_q_max_items = 0,
+        async_wait_strategy wait_strategy = async_wait_strategy::blocking, size_t thread_q_max_items = default_thread_q_max_items);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
+    thread_pool(size_t q_max_items, size_t threads_n, async_queue_type queue_type, size_t priority_q_max_items = 0,
+        async_wait_strategy wait_strategy = async_wait_strategy::blocking, size_t thread_q_max_items = default_thread_q_max_items);
     thread_pool(size_t q_max_items, size_t threads_n);
 
-    // message all threads to terminate gracefully and join them
+    // stop accepting messages (posting throws from then on) and wait for the threads
+    // still posting (see thread_pool_pin), so no message comes after the terminate ones.
+    // then message all threads to terminate gracefully and join them, and detach the loggers
+    // still registered. the memory is freed once no thread pins the pool anymore.
     ~thread_pool();
 
     thread_pool(const thread_pool &) = delete;
     thread_pool &operator=(thread_pool &&) = delete;
 
-    void post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy);
-    void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
+    // add the logger to the logger table and return its handle for the post_* functions.
+    // the table refers to the logger without owning it, see release_logger().
+    async_logger_index register_logger(async_logger &logger);
+    // called by the logger's destructor, with the pool pinned. posts a release message for each
+    // worker and waits until every worker has passed one, so the messages queued before are all
+    // processed. once the pool is closing, it waits for the workers to be joined instead.
+    // on a worker thread of this pool (e.g. from a sink), the calling worker passes its own
+    // release at once: the messages of the logger it has taken from the queue and not written
+    // yet are skipped. it still waits for the other workers, so it must not hold a lock they
+    // need to get there (e.g. the mutex of a sink they share), nor race with ~thread_pool().
+    void release_logger(async_logger_index index);
+
+    void post_log(async_logger_index logger_index, const details::log_msg &msg, async_overflow_policy overflow_policy);
+    void post_deferred_log(async_logger_index logger_index, const details::log_msg &msg, string_view_t fmt, deferred_format_fn format_fn,
+        async_overflow_policy overflow_policy);
+    void post_flush(async_logger_index logger_index, async_overflow_policy overflow_policy);
     size_t overrun_counter();
     size_t queue_size();
+    bool has_priority_lane() const;
+    async_wait_strategy wait_strategy() const;
+    async_queue_type queue_type() const;
+    size_t worker_count() const;
+    // true once the destructor started: the pool takes no more messages
+    bool closing() const;
+
+    // fraction of the main queue capacity in use
+    float queue_load();
 
 private:
-    q_type q_;
+    // polls before a spinning worker starts to yield or park
+    static const size_t spin_attempts = 256;
+
+    const async_wait_strategy wait_strategy_;
+    const async_queue_type queue_type_;
+    std::unique_ptr<async_msg_queue> q_;
+    std::unique_ptr<lockfree_q_type> priority_q_;
 
     std::vector<std::thread> threads_;
+    worker_parker parker_;
+    // blocking strategy: workers waiting on the main queue, and whether a wakeup for them is queued.
+    // severe messages post a wakeup only while a worker waits (spin_park uses parker_ instead).
+    std::atomic<size_t> blocked_workers_{0};
+    std::atomic<bool> wakeup_posted_{false};
+
+    // logger table, allocated in chunks so entries never move while workers read them.
+    // chunk k holds logger_chunk_size << k entries, enough chunks for any async_logger_index.
+    static const size_t logger_chunk_size = 64;
+    static const size_t max_logger_chunks = 27;
+    std::mutex loggers_mutex_;
+    std::condition_variable loggers_released_cv_;
+    // shutdown state, see ~thread_pool(). orphans are the loggers destroyed while closing,
+    // waiting for the workers to be joined.
+    std::atomic<bool> closing_{false};
+    bool joined_ = false;
+    size_t orphans_ = 0;
+    std::unique_ptr<async_logger_entry[]> logger_chunks_[max_logger_chunks];
+    size_t loggers_end_ = 0; // one past the highest entry ever used
+    std::vector<async_logger_index> free_loggers_;
+
+    async_logger_entry &entry_at_(async_logger_index index);
+    static void locate_logger_(async_logger_index index, size_t &chunk, size_t &offset);
+    // post a release message for each worker. return the overrun counter before posting.
+    size_t post_release_(async_logger_index index, std::unique_lock<std::mutex> &lock);
+    // a worker passed a release message of the logger
+    void ack_release_(async_logger_index index, size_t worker_id);
+    // index of the calling worker in threads_, threads_.size() if not a worker of this pool
+    size_t worker_id_() const;
 
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
-    void worker_loop_();
+    void post_priority_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    // wake a parked worker after a message was queued (spin_park only)
+    void notify_workers_();
+    void worker_loop_(size_t worker_id);
 
-    // process next message in the queue
+    // true if the priority lane holds messages
+    bool priority_pending_();
+
+    // take the next messages from the queue, waiting according to the wait strategy.
+    // return 0 if none arrived within wait_duration, or at once if the priority lane has messages.
+    size_t dequeue_batch_(std::vector<async_msg> &batch, std::chrono::milliseconds wait_duration);
+
+    // process the next batch of messages in the queue.
+    // consecutive log messages of the same logger are passed to its sinks at once.
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_batch_(
+        size_t worker_id, std::vector<async_msg> &batch, std::vector<async_msg> &priority_batch, std::vector<log_msg> &run);
+
+    // process whatever is waiting in the priority lane, without blocking
+    void drain_priority_(size_t worker_id, std::vector<async_msg> &priority_batch, std::vector<log_msg> &run);
+
+    // pass the log messages starting at msgs[i] which belong to the same logger to its sinks.
+    // return the index past the run.
+    size_t sink_run_(size_t worker_id, async_msg *msgs, size_t i, size_t count, std::vector<log_msg> &run);
 };
 
 } // namespace details
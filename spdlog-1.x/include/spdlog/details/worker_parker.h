@@ -0,0 +1,121 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// parking spot for consumer threads which poll their queue.
+// park_for(..) - will block until notified or timeout have passed, unless
+// ready() returns true after the consumer was registered as parked.
+// notify() - wakes a parked consumer. Costs a fence and a load when no
+// consumer is parked, so producers can call it after every enqueue.
+//
+// On Linux the consumer sleeps on a futex, elsewhere on a condition variable.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef __linux__
+#    include <climits>
+#    include <ctime>
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#else
+#    include <condition_variable>
+#    include <mutex>
+#endif
+
+namespace spdlog {
+namespace details {
+
+// hint to the cpu that the thread is spinning
+inline void cpu_relax()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+class worker_parker
+{
+public:
+    worker_parker() = default;
+    worker_parker(const worker_parker &) = delete;
+    worker_parker &operator=(const worker_parker &) = delete;
+
+    // Return false if ready() was true before parking, true otherwise
+    template<typename Ready>
+    bool park_for(std::chrono::nanoseconds timeout, Ready &&ready)
+    {
+#ifdef __linux__
+        parked_.fetch_add(1, std::memory_order_relaxed);
+        uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+        // pairs with the fence in notify(): either the producer sees us parked,
+        // or ready() sees its item.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready())
+        {
+            parked_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        // returns at once if notify() changed the epoch meanwhile
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(secs.count());
+        ts.tv_nsec = static_cast<long>((timeout - secs).count());
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, &ts, nullptr, 0);
+        parked_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+#else
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        parked_.fetch_add(1, std::memory_order_relaxed);
+        uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready())
+        {
+            parked_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        park_cv_.wait_for(lock, timeout, [this, epoch] { return this->epoch_.load(std::memory_order_relaxed) != epoch; });
+        parked_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+#endif
+    }
+
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+#ifdef __linux__
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        park_cv_.notify_one();
+#endif
+    }
+
+    size_t parked()
+    {
+        return parked_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit integer");
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<size_t> parked_{0};
+#ifndef __linux__
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+#endif
+};
+} // namespace details
+} // namespace spdlog
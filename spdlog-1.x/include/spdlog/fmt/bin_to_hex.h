@@ -5,8 +5,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cctype>
+#include <iterator>
+#include <type_traits>
 #include <spdlog/common.h>
+#include <spdlog/details/deferred_args.h>
+#include <spdlog/details/hex_dump.h>
 
 #if defined(__has_include)
 #    if __has_include(<version>)
@@ -35,6 +40,9 @@
 // char buf[128];
 // logger->info("Some buffer {:X}", spdlog::to_hex(std::begin(buf), std::end(buf)));
 // logger->info("Some buffer {:X}", spdlog::to_hex(std::begin(buf), std::end(buf), 16));
+//
+// Contiguous ranges (containers with data(), spans and pointer ranges) are dumped
+// by the vectorized details::hex_dump(), straight into the destination buffer.
 
 namespace spdlog {
 namespace details {
@@ -67,27 +75,93 @@ private:
     It begin_, end_;
     size_t size_per_line_;
 };
+
+template<typename... Ts>
+struct make_void
+{
+    using type = void;
+};
+
+// dump containers with data() through a pointer range, others through their const_iterator
+template<typename Container, typename = void>
+struct dump_range
+{
+    using iterator = typename Container::const_iterator;
+    static iterator range_begin(const Container &container)
+    {
+        return std::begin(container);
+    }
+    static iterator range_end(const Container &container)
+    {
+        return std::end(container);
+    }
+};
+
+template<typename Container>
+struct dump_range<Container, typename make_void<decltype(std::declval<const Container &>().data())>::type>
+{
+    using iterator = decltype(std::declval<const Container &>().data());
+    static iterator range_begin(const Container &container)
+    {
+        return container.data();
+    }
+    static iterator range_end(const Container &container)
+    {
+        return container.data() + container.size();
+    }
+};
+
+// dump_info over a pointer range of bytes can use the vectorized hex_dump()
+template<typename It>
+struct is_contiguous_bytes
+    : std::integral_constant<bool, std::is_pointer<It>::value && sizeof(typename std::iterator_traits<It>::value_type) == 1>
+{};
+
+// append the dump to out: in place if out appends to a fmt buffer, through a temporary buffer otherwise
+template<typename OutputIt>
+inline OutputIt hex_dump_to(OutputIt out, const unsigned char *data, size_t n, const hex_dump_spec &spec)
+{
+    memory_buf_t buf;
+    hex_dump(data, n, spec, buf);
+    return std::copy(buf.data(), buf.data() + buf.size(), out);
+}
+
+#    if !defined(SPDLOG_USE_STD_FORMAT) && FMT_VERSION >= 80000
+inline fmt::appender hex_dump_to(fmt::appender out, const unsigned char *data, size_t n, const hex_dump_spec &spec)
+{
+    auto &buf = fmt::detail::get_container(out);
+    size_t size = hex_dump_size(n, spec);
+    // reserve the exact size: some buffers never shrink, others flush instead of growing
+    buf.try_reserve(buf.size() + size);
+    size_t old_size = buf.size();
+    if (buf.capacity() - old_size < size)
+    {
+        return hex_dump_to<fmt::appender>(out, data, n, spec);
+    }
+    hex_dump(data, n, spec, buf.data() + old_size);
+    buf.try_resize(old_size + size);
+    return out;
+}
+#    endif
 } // namespace details
 
 // create a dump_info that wraps the given container
 template<typename Container>
-inline details::dump_info<typename Container::const_iterator> to_hex(const Container &container, size_t size_per_line = 32)
+inline details::dump_info<typename details::dump_range<Container>::iterator> to_hex(const Container &container, size_t size_per_line = 32)
 {
     static_assert(sizeof(typename Container::value_type) == 1, "sizeof(Container::value_type) != 1");
-    using Iter = typename Container::const_iterator;
-    return details::dump_info<Iter>(std::begin(container), std::end(container), size_per_line);
+    using range = details::dump_range<Container>;
+    return details::dump_info<typename range::iterator>(range::range_begin(container), range::range_end(container), size_per_line);
 }
 
 #if __cpp_lib_span >= 202002L
 
 template<typename Value, size_t Extent>
-inline details::dump_info<typename std::span<Value, Extent>::iterator> to_hex(
-    const std::span<Value, Extent> &container, size_t size_per_line = 32)
+inline details::dump_info<Value *> to_hex(const std::span<Value, Extent> &container, size_t size_per_line = 32)
 {
     using Container = std::span<Value, Extent>;
     static_assert(sizeof(typename Container::value_type) == 1, "sizeof(Container::value_type) != 1");
-    using Iter = typename Container::iterator;
-    return details::dump_info<Iter>(std::begin(container), std::end(container), size_per_line);
+    return details::dump_info<Value *>(container.data(), container.data() + container.size(), size_per_line);
 }
 
 #endif
@@ -157,6 +231,30 @@ struct formatter<spdlog::details::dump_info<T>, char>
     // format the given bytes range as hex
     template<typename FormatContext, typename Container>
     auto format(const spdlog::details::dump_info<Container> &the_range, FormatContext &ctx) -> decltype(ctx.out())
+    {
+        return format_(the_range, ctx, std::integral_constant<bool, spdlog::details::is_contiguous_bytes<Container>::value>{});
+    }
+
+#if defined(SPDLOG_USE_STD_FORMAT) || FMT_VERSION >= 60000
+    template<typename FormatContext, typename Container>
+    auto format_(const spdlog::details::dump_info<Container> &the_range, FormatContext &ctx, std::true_type) -> decltype(ctx.out())
+    {
+        spdlog::details::hex_dump_spec spec;
+        spec.size_per_line = the_range.size_per_line();
+        spec.uppercase = use_uppercase;
+        spec.delimiters = put_delimiters;
+        spec.positions = put_positions;
+        spec.newlines = put_newlines;
+        spec.ascii = show_ascii;
+        auto data = reinterpret_cast<const unsigned char *>(the_range.get_begin());
+        auto size = static_cast<size_t>(the_range.get_end() - the_range.get_begin());
+        return spdlog::details::hex_dump_to(ctx.out(), data, size, spec);
+    }
+#endif
+
+    template<typename FormatContext, typename Container, bool Contiguous>
+    auto format_(const spdlog::details::dump_info<Container> &the_range, FormatContext &ctx, std::integral_constant<bool, Contiguous>)
+        -> decltype(ctx.out())
     {
         SPDLOG_CONSTEXPR const char *hex_upper = "0123456789ABCDEF";
         SPDLOG_CONSTEXPR const char *hex_lower = "0123456789abcdef";
@@ -246,3 +344,14 @@ struct formatter<spdlog::details::dump_info<T>, char>
     }
 };
 } // namespace std
+
+namespace spdlog {
+namespace details {
+// deferred_format_fn for async_logger::log_hex_deferred(): the queued payload is the raw bytes
+template<size_t SizePerLine>
+void format_hex_deferred(string_view_t fmt, string_view_t bytes, memory_buf_t &dest)
+{
+    deferred_args<>::format(fmt, nullptr, dest, to_hex(bytes.data(), bytes.data() + bytes.size(), SizePerLine));
+}
+} // namespace details
+} // namespace spdlog
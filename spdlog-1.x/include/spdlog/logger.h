@@ -33,7 +33,7 @@
         {                                                                                                                                  \
             if (location.filename)                                                                                                         \
             {                                                                                                                              \
-                err_handler_(fmt_lib::format(SPDLOG_FMT_STRING("{} [{}({})]"), ex.what(), location.filename, location.line));              \
+                err_handler_(spdlog::fmt_lib::format(SPDLOG_FMT_STRING("{} [{}({})]"), ex.what(), location.filename, location.line));      \
             }                                                                                                                              \
             else                                                                                                                           \
             {                                                                                                                              \
@@ -122,6 +122,21 @@ public:
         log_it_(log_msg, log_enabled, traceback_enabled);
     }
 
+    // log a record with the number a sink tracks it by, see details::log_msg::sequence
+    void log_sequenced(source_loc loc, level::level_enum lvl, string_view_t msg, std::uint64_t sequence)
+    {
+        bool log_enabled = should_log(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        if (!log_enabled && !traceback_enabled)
+        {
+            return;
+        }
+
+        details::log_msg log_msg(loc, name_, lvl, msg);
+        log_msg.sequence = sequence;
+        log_it_(log_msg, log_enabled, traceback_enabled);
+    }
+
     void log(source_loc loc, level::level_enum lvl, string_view_t msg)
     {
         bool log_enabled = should_log(lvl);
@@ -317,7 +332,7 @@ public:
 
     // set formatting for the sinks in this logger.
     // each sink will get a separate instance of the formatter object.
-    void set_formatter(std::unique_ptr<formatter> f);
+    virtual void set_formatter(std::unique_ptr<formatter> f);
 
     void set_pattern(std::string pattern, pattern_time_type time_type = pattern_time_type::local);
 
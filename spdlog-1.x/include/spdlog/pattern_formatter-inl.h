@@ -1017,6 +1017,40 @@ private:
     memory_buf_t cached_datetime_;
 };
 
+// Run of consecutive date/time flags and literal text (e.g. "[%D %H:%M:%S:").
+// Its output changes only once a second, so it is rendered into a cache on
+// the first message of each second and copied for the rest. Sub-second flags
+// (%e, %f, %F) are never part of a run and are rendered per message.
+// Like the rest of the formatter, not thread safe: each sink or worker owns its
+// own (cloned) pattern_formatter.
+class datetime_run_formatter final : public flag_formatter
+{
+public:
+    explicit datetime_run_formatter(std::vector<std::unique_ptr<flag_formatter>> formatters)
+        : formatters_(std::move(formatters))
+    {}
+
+    void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override
+    {
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+        if (cache_timestamp_ != secs || cached_run_.size() == 0)
+        {
+            cached_run_.clear();
+            for (auto &f : formatters_)
+            {
+                f->format(msg, tm_time, cached_run_);
+            }
+            cache_timestamp_ = secs;
+        }
+        dest.append(cached_run_.begin(), cached_run_.end());
+    }
+
+private:
+    std::vector<std::unique_ptr<flag_formatter>> formatters_;
+    std::chrono::seconds cache_timestamp_{0};
+    memory_buf_t cached_run_;
+};
+
 } // namespace details
 
 SPDLOG_INLINE pattern_formatter::pattern_formatter(
@@ -1056,6 +1090,19 @@ SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const
     return std::move(cloned);
 }
 
+SPDLOG_INLINE std::string pattern_formatter::key() const
+{
+    if (!custom_handlers_.empty())
+    {
+        return {};
+    }
+    std::string rv = pattern_;
+    rv.push_back('\0');
+    rv.push_back(pattern_time_type_ == pattern_time_type::local ? 'l' : 'u');
+    rv += eol_;
+    return rv;
+}
+
 SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
 {
     if (need_localtime_)
@@ -1388,6 +1435,8 @@ SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &patter
     auto end = pattern.end();
     std::unique_ptr<details::aggregate_formatter> user_chars;
     formatters_.clear();
+    // which formatters may be rendered once a second, see merge_datetime_runs_()
+    std::vector<details::flag_kind> kinds;
     for (auto it = pattern.begin(); it != end; ++it)
     {
         if (*it == '%')
@@ -1395,6 +1444,7 @@ SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &patter
             if (user_chars) // append user chars found so far
             {
                 formatters_.push_back(std::move(user_chars));
+                kinds.push_back(details::flag_kind::literal);
             }
 
             auto padding = handle_padspec_(++it, end);
@@ -1409,6 +1459,7 @@ SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &patter
                 {
                     handle_flag_<details::null_scoped_padder>(*it, padding);
                 }
+                kinds.resize(formatters_.size(), is_datetime_flag_(*it) ? details::flag_kind::datetime : details::flag_kind::other);
             }
             else
             {
@@ -1427,6 +1478,49 @@ SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &patter
     if (user_chars) // append raw chars found so far
     {
         formatters_.push_back(std::move(user_chars));
+        kinds.push_back(details::flag_kind::literal);
+    }
+    merge_datetime_runs_(kinds);
+}
+
+// date/time flags rendered from the cached tm only, i.e. same output for the whole second
+SPDLOG_INLINE bool pattern_formatter::is_datetime_flag_(char flag) const
+{
+    static const char datetime_flags[] = "aAbhBcCYDxmdHIMSprRTXz";
+    return custom_handlers_.find(flag) == custom_handlers_.end() && flag != '\0' && std::strchr(datetime_flags, flag) != nullptr;
+}
+
+// replace each run of date/time flags and literal text with a single datetime_run_formatter
+SPDLOG_INLINE void pattern_formatter::merge_datetime_runs_(const std::vector<details::flag_kind> &kinds)
+{
+    std::vector<std::unique_ptr<details::flag_formatter>> merged;
+    std::vector<std::unique_ptr<details::flag_formatter>> run;
+    bool run_has_datetime = false;
+    auto flush_run = [&]() {
+        if (run_has_datetime)
+        {
+            merged.push_back(details::make_unique<details::datetime_run_formatter>(std::move(run)));
+        }
+        else
+        {
+            std::move(run.begin(), run.end(), std::back_inserter(merged));
+        }
+        run.clear();
+        run_has_datetime = false;
+    };
+
+    for (size_t i = 0; i < formatters_.size(); ++i)
+    {
+        if (kinds[i] == details::flag_kind::other)
+        {
+            flush_run();
+            merged.push_back(std::move(formatters_[i]));
+            continue;
+        }
+        run_has_datetime = run_has_datetime || kinds[i] == details::flag_kind::datetime;
+        run.push_back(std::move(formatters_[i]));
     }
+    flush_run();
+    formatters_ = std::move(merged);
 }
 } // namespace spdlog
@@ -47,6 +47,14 @@ struct padding_info
     bool enabled_ = false;
 };
 
+// what a compiled flag_formatter depends on
+enum class flag_kind
+{
+    literal,  // nothing: user text
+    datetime, // the cached tm only
+    other
+};
+
 class SPDLOG_API flag_formatter
 {
 public:
@@ -90,6 +98,8 @@ public:
 
     std::unique_ptr<formatter> clone() const override;
     void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    // pattern, time type and eol. empty if custom flags are in use.
+    std::string key() const override;
 
     template<typename T, typename... Args>
     pattern_formatter &add_flag(char flag, Args &&... args)
@@ -120,6 +130,8 @@ private:
     static details::padding_info handle_padspec_(std::string::const_iterator &it, std::string::const_iterator end);
 
     void compile_pattern_(const std::string &pattern);
+    bool is_datetime_flag_(char flag) const;
+    void merge_datetime_runs_(const std::vector<details::flag_kind> &kinds);
 };
 } // namespace spdlog
 
@@ -18,7 +18,7 @@ SPDLOG_INLINE ansicolor_sink<ConsoleMutex>::ansicolor_sink(FILE *target_file, co
     : target_file_(target_file)
     , mutex_(ConsoleMutex::mutex())
     , formatter_(details::make_unique<spdlog::pattern_formatter>())
-
+    , formatter_key_(formatter_->key())
 {
     set_color_mode(mode);
     colors_[level::trace] = to_string_(white);
@@ -40,29 +40,66 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_color(level::level_enum col
 template<typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log(const details::log_msg &msg)
 {
-    // Wrap the originally formatted message in color codes.
-    // If color is not supported in the terminal, log as is instead.
     std::lock_guard<mutex_t> lock(mutex_);
+    format_and_print_(msg);
+    fflush(target_file_);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_formatted_batch(
+    const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    bool shared = !formatter_key.empty() && formatter_key == formatter_key_;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!should_log(msgs[i].level))
+        {
+            continue;
+        }
+        if (shared)
+        {
+            print_formatted_(msgs[i].level, formatted[i].buf, formatted[i].color_range_start, formatted[i].color_range_end);
+        }
+        else
+        {
+            format_and_print_(msgs[i]);
+        }
+    }
+    fflush(target_file_);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::format_and_print_(const details::log_msg &msg)
+{
     msg.color_range_start = 0;
     msg.color_range_end = 0;
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
-    if (should_do_colors_ && msg.color_range_end > msg.color_range_start)
+    print_formatted_(msg.level, formatted, msg.color_range_start, msg.color_range_end);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_formatted_(
+    level::level_enum msg_level, const memory_buf_t &formatted, size_t color_range_start, size_t color_range_end)
+{
+    // Wrap the originally formatted message in color codes.
+    // If color is not supported in the terminal, log as is instead.
+    if (should_do_colors_ && color_range_end > color_range_start)
     {
         // before color range
-        print_range_(formatted, 0, msg.color_range_start);
+        print_range_(formatted, 0, color_range_start);
         // in color range
-        print_ccode_(colors_[static_cast<size_t>(msg.level)]);
-        print_range_(formatted, msg.color_range_start, msg.color_range_end);
+        print_ccode_(colors_[static_cast<size_t>(msg_level)]);
+        print_range_(formatted, color_range_start, color_range_end);
         print_ccode_(reset);
         // after color range
-        print_range_(formatted, msg.color_range_end, formatted.size());
+        print_range_(formatted, color_range_end, formatted.size());
     }
     else // no color
     {
         print_range_(formatted, 0, formatted.size());
     }
-    fflush(target_file_);
 }
 
 template<typename ConsoleMutex>
@@ -77,6 +114,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_pattern(const std::string &
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    formatter_key_ = formatter_->key();
 }
 
 template<typename ConsoleMutex>
@@ -84,6 +122,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_formatter(std::unique_ptr<s
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::move(sink_formatter);
+    formatter_key_ = formatter_->key();
 }
 
 template<typename ConsoleMutex>
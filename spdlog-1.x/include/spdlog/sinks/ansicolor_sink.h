@@ -40,6 +40,9 @@ public:
     bool should_color();
 
     void log(const details::log_msg &msg) override;
+    // prints messages formatted by the logger as they are, using their color ranges
+    void log_formatted_batch(
+        const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key) override;
     void flush() override;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
@@ -84,7 +87,11 @@ private:
     mutex_t &mutex_;
     bool should_do_colors_;
     std::unique_ptr<spdlog::formatter> formatter_;
+    std::string formatter_key_;
     std::array<std::string, level::n_levels> colors_;
+    // format msg with formatter_ and print it, without flushing
+    void format_and_print_(const details::log_msg &msg);
+    void print_formatted_(level::level_enum msg_level, const memory_buf_t &formatted, size_t color_range_start, size_t color_range_end);
     void print_ccode_(const string_view_t &color_code);
     void print_range_(const memory_buf_t &formatted, size_t start, size_t end);
     static std::string to_string_(const string_view_t &sv);
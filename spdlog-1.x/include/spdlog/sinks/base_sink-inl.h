@@ -15,11 +15,13 @@
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink()
     : formatter_{details::make_unique<spdlog::pattern_formatter>()}
+    , formatter_key_{formatter_->key()}
 {}
 
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink(std::unique_ptr<spdlog::formatter> formatter)
     : formatter_{std::move(formatter)}
+    , formatter_key_{formatter_ ? formatter_->key() : std::string{}}
 {}
 
 template<typename Mutex>
@@ -29,6 +31,28 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &
     sink_it_(msg);
 }
 
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(const details::log_msg *msgs, size_t count)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    sink_batch_(msgs, count);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted_batch(
+    const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    if (!formatter_key.empty() && formatter_key == formatter_key_)
+    {
+        sink_formatted_batch_(msgs, formatted, count);
+    }
+    else
+    {
+        sink_batch_(msgs, count);
+    }
+}
+
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush()
 {
@@ -50,6 +74,24 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_pt
     set_formatter_(std::move(sink_formatter));
 }
 
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i].level))
+        {
+            sink_it_(msgs[i]);
+        }
+    }
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *, size_t count)
+{
+    sink_batch_(msgs, count);
+}
+
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::string &pattern)
 {
@@ -60,4 +102,5 @@ template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter)
 {
     formatter_ = std::move(sink_formatter);
+    formatter_key_ = formatter_->key();
 }
@@ -7,6 +7,8 @@
 // concrete implementation should override the sink_it_() and flush_()  methods.
 // locking is taken care of in this class - no locking needed by the
 // implementers..
+// sinks which can write a whole batch at once may also override sink_batch_(),
+// and sinks which can write messages formatted by the logger sink_formatted_batch_().
 //
 
 #include <spdlog/common.h>
@@ -30,6 +32,9 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final;
+    void log_batch(const details::log_msg *msgs, size_t count) final;
+    void log_formatted_batch(
+        const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key) final;
     void flush() final;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final;
@@ -37,9 +42,18 @@ public:
 protected:
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
+    // key of formatter_, see formatter::key()
+    std::string formatter_key_;
     Mutex mutex_;
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // called under the lock with a batch of messages. implementations must skip
+    // messages not allowed by the sink level (should_log()).
+    virtual void sink_batch_(const details::log_msg *msgs, size_t count);
+    // called under the lock with a batch of messages already rendered by a formatter with the
+    // same key as formatter_. implementations must skip messages not allowed by the sink level.
+    // the default implementation formats them again with sink_batch_().
+    virtual void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count);
     virtual void flush_() = 0;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
@@ -34,6 +34,35 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
     file_helper_.write(formatted);
 }
 
+// format the whole batch and write it at once
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t count)
+{
+    batch_.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (base_sink<Mutex>::should_log(msgs[i].level))
+        {
+            base_sink<Mutex>::formatter_->format(msgs[i], batch_);
+        }
+    }
+    file_helper_.write(batch_);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count)
+{
+    batch_.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (base_sink<Mutex>::should_log(msgs[i].level))
+        {
+            batch_.append(formatted[i].buf.data(), formatted[i].buf.data() + formatted[i].buf.size());
+        }
+    }
+    file_helper_.write(batch_);
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::flush_()
 {
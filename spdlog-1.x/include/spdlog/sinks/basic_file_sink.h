@@ -25,10 +25,14 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t count) override;
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override;
     void flush_() override;
 
 private:
     details::file_helper file_helper_;
+    // batch buffer, reused so that writing a batch does not allocate once it has grown
+    memory_buf_t batch_;
 };
 
 using basic_file_sink_mt = basic_file_sink<std::mutex>;
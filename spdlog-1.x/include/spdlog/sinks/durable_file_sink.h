@@ -0,0 +1,289 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// File sink with group commit of the records at or above a durability level.
+// Records are written as by basic_file_sink. A helper thread waits for a durable
+// record, lets more of them arrive during the commit window, then flushes the file
+// and calls fdatasync() once for all of them.
+//
+// A caller which needs its record on disk logs it with a sequence number of the sink:
+//
+//     auto sequence = sink->next_durable_sequence();
+//     logger->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "...", sequence);
+//     bool on_disk = sink->wait_durable(sequence, std::chrono::seconds(1));
+//
+// The number travels with the record, so this also works through an async logger and
+// with other durable records logged meanwhile, as long as the record is not dropped
+// (by a logger or sink level, or an overflow policy). The wait then times out.
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+class durable_file_sink final : public base_sink<Mutex>
+{
+public:
+    explicit durable_file_sink(const filename_t &filename, bool truncate = false, level::level_enum durable_level = level::critical,
+        std::chrono::milliseconds commit_window = std::chrono::milliseconds(2), const file_event_handlers &event_handlers = {})
+        : durable_level_{durable_level}
+        , commit_window_{commit_window}
+        , file_helper_{event_handlers}
+    {
+        file_helper_.open(filename, truncate);
+        commit_thread_ = std::thread([this] { commit_loop_(); });
+    }
+
+    // commit what is pending before the file is closed
+    ~durable_file_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(commit_mutex_);
+            stop_ = true;
+        }
+        commit_cv_.notify_all();
+        commit_thread_.join();
+    }
+
+    const filename_t &filename() const
+    {
+        return file_helper_.filename();
+    }
+
+    // number for the next record to wait for, see logger::log_sequenced()
+    std::uint64_t next_durable_sequence()
+    {
+        return ++last_sequence_;
+    }
+
+    // wait until the record with the sequence number is on disk. false on timeout.
+    bool wait_durable(std::uint64_t sequence, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(commit_mutex_);
+        bool on_disk = durable_cv_.wait_for(lock, timeout, [this, sequence] { return durable_.count(sequence) != 0; });
+        if (on_disk)
+        {
+            durable_.erase(sequence);
+        }
+        else
+        {
+            abandoned_.insert(sequence);
+            keep_newest_(abandoned_);
+        }
+        return on_disk;
+    }
+
+    // number of fdatasync() calls so far
+    size_t commit_count()
+    {
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        return commits_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        {
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            file_helper_.write(formatted);
+        }
+        if (msg.level >= durable_level_)
+        {
+            add_durable_(&msg, 1);
+        }
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        memory_buf_t batch;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                base_sink<Mutex>::formatter_->format(msgs[i], batch);
+            }
+        }
+        write_batch_(msgs, count, batch);
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        memory_buf_t batch;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                batch.append(formatted[i].buf.data(), formatted[i].buf.data() + formatted[i].buf.size());
+            }
+        }
+        write_batch_(msgs, count, batch);
+    }
+
+    void flush_() override
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        file_helper_.flush();
+    }
+
+private:
+    // numbers nobody waits for, e.g. given by another sink of the logger, are not kept forever
+    static void keep_newest_(std::set<std::uint64_t> &sequences)
+    {
+        if (sequences.size() > 4096)
+        {
+            sequences.erase(sequences.begin());
+        }
+    }
+
+    void write_batch_(const details::log_msg *msgs, size_t count, const memory_buf_t &batch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            file_helper_.write(batch);
+        }
+        add_durable_(msgs, count);
+    }
+
+    // note the durable records allowed by the sink level, and wake the commit thread
+    void add_durable_(const details::log_msg *msgs, size_t count)
+    {
+        bool added = false;
+        {
+            std::lock_guard<std::mutex> lock(commit_mutex_);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (msgs[i].level >= durable_level_ && base_sink<Mutex>::should_log(msgs[i].level))
+                {
+                    if (msgs[i].sequence != 0)
+                    {
+                        received_.push_back(msgs[i].sequence);
+                    }
+                    added = true;
+                }
+            }
+            pending_ = pending_ || added;
+        }
+        if (added)
+        {
+            commit_cv_.notify_all();
+        }
+    }
+
+    // runs until the sink is destroyed and nothing is pending
+    void commit_loop_()
+    {
+        std::unique_lock<std::mutex> lock(commit_mutex_);
+        for (;;)
+        {
+            commit_cv_.wait(lock, [this] { return pending_ || stop_; });
+            if (!pending_)
+            {
+                return;
+            }
+            // let the records logged with this one join the commit
+            commit_cv_.wait_for(lock, commit_window_, [this] { return stop_; });
+            pending_ = false;
+            committing_.swap(received_);
+            lock.unlock();
+
+            bool synced = false;
+            SPDLOG_TRY
+            {
+                {
+                    std::lock_guard<std::mutex> file_lock(file_mutex_);
+                    file_helper_.flush();
+                }
+                file_helper_.sync();
+                synced = true;
+            }
+            SPDLOG_CATCH_STD
+
+            lock.lock();
+            if (synced)
+            {
+                commits_++;
+                for (auto sequence : committing_)
+                {
+                    if (abandoned_.erase(sequence) == 0)
+                    {
+                        durable_.insert(sequence);
+                        keep_newest_(durable_);
+                    }
+                }
+                durable_cv_.notify_all();
+            }
+            else
+            {
+                // committed with the next durable record
+                received_.insert(received_.end(), committing_.begin(), committing_.end());
+            }
+            committing_.clear();
+        }
+    }
+
+    level::level_enum durable_level_;
+    std::chrono::milliseconds commit_window_;
+
+    // the commit thread flushes the file while the sink writes to it
+    std::mutex file_mutex_;
+    details::file_helper file_helper_;
+
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::condition_variable durable_cv_;
+    std::atomic<std::uint64_t> last_sequence_{0};
+    // sequence numbers of the records written to the file, of the records the running
+    // commit syncs, and of the records on disk whose caller has not seen it yet
+    std::vector<std::uint64_t> received_;
+    std::vector<std::uint64_t> committing_;
+    std::set<std::uint64_t> durable_;
+    // the waits which timed out: their records are not kept in durable_
+    std::set<std::uint64_t> abandoned_;
+    bool pending_ = false;
+    bool stop_ = false;
+    size_t commits_ = 0;
+    std::thread commit_thread_;
+};
+
+using durable_file_sink_mt = durable_file_sink<std::mutex>;
+using durable_file_sink_st = durable_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> durable_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    level::level_enum durable_level = level::critical, std::chrono::milliseconds commit_window = std::chrono::milliseconds(2))
+{
+    return Factory::template create<sinks::durable_file_sink_mt>(logger_name, filename, truncate, durable_level, commit_window);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> durable_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false,
+    level::level_enum durable_level = level::critical, std::chrono::milliseconds commit_window = std::chrono::milliseconds(2))
+{
+    return Factory::template create<sinks::durable_file_sink_st>(logger_name, filename, truncate, durable_level, commit_window);
+}
+
+} // namespace spdlog
@@ -0,0 +1,363 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/periodic_worker.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Sink writing each level to its own file through one shared write buffer.
+// The messages of all levels are formatted into the buffer as they come. When it
+// fills up, or on flush(), the records of each file are gathered and passed to it with
+// a single fwrite(), so mixed level traffic costs one write per file instead of one per
+// message and file buffer.
+//
+// Example:
+//
+//     auto router = std::make_shared<spdlog::sinks::level_router_sink_mt>(
+//         spdlog::sinks::level_routes{{spdlog::level::info, "logs/info.log"}, {spdlog::level::warn, "logs/info.log"},
+//             {spdlog::level::err, "logs/errors.log"}, {spdlog::level::critical, "logs/errors.log"}});
+//     spdlog::logger l("logger", router);
+//
+// Several sinks, each with its own formatter, may share the files and the buffer
+// through a level_router:
+//
+//     auto router = std::make_shared<spdlog::sinks::level_router>(routes);
+//     spdlog::logger l1("l1", std::make_shared<spdlog::sinks::level_router_sink_mt>(router));
+//     spdlog::logger l2("l2", std::make_shared<spdlog::sinks::level_router_sink_mt>(router));
+//
+// A sink may also write all its messages to one of the router's files, whatever their level:
+//
+//     spdlog::logger l3("l3", std::make_shared<spdlog::sinks::level_router_sink_mt>(router, "logs/errors.log"));
+//
+// Levels without a route are dropped. Messages stay in the buffer until it is full,
+// the sink is flushed, or the router's flush policy drains it:
+//
+//     router->flush_on(spdlog::level::err);                 // write out as soon as an error is buffered
+//     router->flush_every(std::chrono::milliseconds(500));  // and nothing waits for more than about 500 ms
+
+namespace spdlog {
+namespace sinks {
+
+// level and the file its messages are written to. several levels may share a file.
+using level_routes = std::vector<std::pair<level::level_enum, filename_t>>;
+
+// the files and the write buffer of level_router_sink
+class level_router
+{
+public:
+    static const size_t default_buffer_size = 64 * 1024;
+    // file index for write(..) and write_formatted(..): the file routed for the message level
+    static const size_t by_level = static_cast<size_t>(-1);
+
+    explicit level_router(const level_routes &routes, bool truncate = false, size_t buffer_size = default_buffer_size,
+        const file_event_handlers &event_handlers = {})
+        : buffer_size_{buffer_size}
+    {
+        for (auto &file : route_)
+        {
+            file = no_route;
+        }
+        for (auto &route : routes)
+        {
+            size_t file = find_file_(route.second);
+            if (file == no_route)
+            {
+                file = files_.size();
+                files_.emplace_back(new details::file_helper(event_handlers));
+                files_.back()->open(route.second, truncate);
+            }
+            route_[static_cast<size_t>(route.first)] = file;
+        }
+        buffer_.reserve(buffer_size_);
+    }
+
+    level_router(const level_router &) = delete;
+    level_router &operator=(const level_router &) = delete;
+
+    ~level_router()
+    {
+        flusher_.reset();
+        SPDLOG_TRY
+        {
+            drain_();
+        }
+        SPDLOG_CATCH_STD
+    }
+
+    // write the buffer out as soon as it holds a message of this level or above (level::off: never)
+    void flush_on(level::level_enum lvl)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_level_ = lvl;
+    }
+
+    // write the buffer out at least once per interval, from a helper thread (zero: never),
+    // so buffered messages do not wait for more traffic when logging goes quiet
+    void flush_every(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(flusher_mutex_);
+        // the old worker is joined first, as it takes mutex_
+        flusher_.reset();
+        if (interval > std::chrono::milliseconds::zero())
+        {
+            flusher_ = details::make_unique<details::periodic_worker>(
+                [this] {
+                    SPDLOG_TRY
+                    {
+                        flush();
+                    }
+                    SPDLOG_CATCH_STD
+                },
+                interval);
+        }
+    }
+
+    // the file of the given level, empty if the level is dropped
+    filename_t filename(level::level_enum lvl) const
+    {
+        auto file = route_[static_cast<size_t>(lvl)];
+        return file == no_route ? filename_t{} : files_[file]->filename();
+    }
+
+    bool routed(level::level_enum lvl) const
+    {
+        return route_[static_cast<size_t>(lvl)] != no_route;
+    }
+
+    // whether a level is routed to the file
+    bool has_file(const filename_t &filename) const
+    {
+        return find_file_(filename) != no_route;
+    }
+
+    // index of the file, for write(..) and write_formatted(..). throws if no level is routed to it.
+    size_t file_index(const filename_t &filename) const
+    {
+        auto file = find_file_(filename);
+        if (file == no_route)
+        {
+            throw_spdlog_ex("level_router: no level is routed to " + details::os::filename_to_str(filename));
+        }
+        return file;
+    }
+
+    // format the messages allowed by the sink level into the buffer, for the given file or by level
+    void write(
+        const details::log_msg *msgs, size_t count, level::level_enum sink_level, formatter &msg_formatter, size_t target = by_level)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool severe = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            auto file = target != by_level ? target : route_[static_cast<size_t>(msgs[i].level)];
+            if (file == no_route || msgs[i].level < sink_level)
+            {
+                continue;
+            }
+            size_t offset = buffer_.size();
+            msg_formatter.format(msgs[i], buffer_);
+            records_.push_back(record{file, offset, buffer_.size() - offset});
+            severe = severe || msgs[i].level >= flush_level_;
+        }
+        drain_if_due_(severe);
+    }
+
+    // add the messages allowed by the sink level, already formatted
+    void write_formatted(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, level::level_enum sink_level,
+        size_t target = by_level)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool severe = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            auto file = target != by_level ? target : route_[static_cast<size_t>(msgs[i].level)];
+            if (file == no_route || msgs[i].level < sink_level)
+            {
+                continue;
+            }
+            size_t offset = buffer_.size();
+            buffer_.append(formatted[i].buf.data(), formatted[i].buf.data() + formatted[i].buf.size());
+            records_.push_back(record{file, offset, buffer_.size() - offset});
+            severe = severe || msgs[i].level >= flush_level_;
+        }
+        drain_if_due_(severe);
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_();
+    }
+
+private:
+    static const size_t no_route = static_cast<size_t>(-1);
+
+    // a formatted message in buffer_
+    struct record
+    {
+        size_t file;
+        size_t offset;
+        size_t size;
+    };
+
+    size_t find_file_(const filename_t &filename) const
+    {
+        for (size_t file = 0; file < files_.size(); file++)
+        {
+            if (files_[file]->filename() == filename)
+            {
+                return file;
+            }
+        }
+        return no_route;
+    }
+
+    // drain if the buffer is full or got a message at the flush level
+    void drain_if_due_(bool severe)
+    {
+        if (severe || buffer_.size() >= buffer_size_)
+        {
+            drain_();
+        }
+    }
+
+    // write the buffered messages file by file, keeping their order within each file.
+    // the records of a file are gathered in file_buffer_, unless the buffer holds only them.
+    void drain_()
+    {
+        if (records_.empty())
+        {
+            return;
+        }
+        for (size_t file = 0; file < files_.size(); file++)
+        {
+            file_buffer_.clear();
+            size_t count = 0;
+            for (auto &r : records_)
+            {
+                if (r.file == file)
+                {
+                    file_buffer_.append(buffer_.data() + r.offset, buffer_.data() + r.offset + r.size);
+                    count++;
+                }
+            }
+            if (count == records_.size())
+            {
+                write_file_(file, buffer_);
+                break;
+            }
+            if (count > 0)
+            {
+                write_file_(file, file_buffer_);
+            }
+        }
+        records_.clear();
+        buffer_.clear();
+    }
+
+    // one fwrite() for the whole chunk. the stdio buffer is empty, as each drain flushes it.
+    void write_file_(size_t file, const memory_buf_t &data)
+    {
+        files_[file]->write(data);
+        files_[file]->flush();
+    }
+
+    std::mutex mutex_;
+    std::array<size_t, level::n_levels> route_;
+    std::vector<std::unique_ptr<details::file_helper>> files_;
+    size_t buffer_size_;
+    memory_buf_t buffer_;
+    memory_buf_t file_buffer_;
+    std::vector<record> records_;
+    level::level_enum flush_level_ = level::off;
+    std::mutex flusher_mutex_;
+    std::unique_ptr<details::periodic_worker> flusher_;
+};
+
+template<typename Mutex>
+class level_router_sink final : public base_sink<Mutex>
+{
+public:
+    explicit level_router_sink(const level_routes &routes, bool truncate = false, size_t buffer_size = level_router::default_buffer_size,
+        const file_event_handlers &event_handlers = {})
+        : router_{std::make_shared<level_router>(routes, truncate, buffer_size, event_handlers)}
+    {}
+
+    explicit level_router_sink(std::shared_ptr<level_router> router)
+        : router_{std::move(router)}
+    {}
+
+    // write every message to the router's file filename, whatever its level
+    level_router_sink(std::shared_ptr<level_router> router, const filename_t &filename)
+        : router_{std::move(router)}
+        , file_{router_->file_index(filename)}
+    {}
+
+    const std::shared_ptr<level_router> &router() const
+    {
+        return router_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        router_->write(&msg, 1, level::trace, *base_sink<Mutex>::formatter_, file_);
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        router_->write(msgs, count, base_sink<Mutex>::level(), *base_sink<Mutex>::formatter_, file_);
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        router_->write_formatted(msgs, formatted, count, base_sink<Mutex>::level(), file_);
+    }
+
+    void flush_() override
+    {
+        router_->flush();
+    }
+
+private:
+    std::shared_ptr<level_router> router_;
+    size_t file_ = level_router::by_level;
+};
+
+using level_router_sink_mt = level_router_sink<std::mutex>;
+using level_router_sink_st = level_router_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> level_router_logger_mt(const std::string &logger_name, const sinks::level_routes &routes,
+    bool truncate = false, size_t buffer_size = sinks::level_router::default_buffer_size)
+{
+    return Factory::template create<sinks::level_router_sink_mt>(logger_name, routes, truncate, buffer_size);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> level_router_logger_st(const std::string &logger_name, const sinks::level_routes &routes,
+    bool truncate = false, size_t buffer_size = sinks::level_router::default_buffer_size)
+{
+    return Factory::template create<sinks::level_router_sink_st>(logger_name, routes, truncate, buffer_size);
+}
+
+} // namespace spdlog
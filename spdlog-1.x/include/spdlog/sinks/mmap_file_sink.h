@@ -0,0 +1,387 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Rotating file sink based on size, writing through a memory mapping. POSIX only.
+// The file is allocated at max_size and mapped. Each record gets its own range of the
+// mapping from an atomic cursor and is copied there: no stdio buffer, no system call
+// per record, and threads logging at the same time (e.g. several async workers) only
+// share the cursor and a count of writers, not a lock. The formatters are taken from
+// a pool under a lock once per batch. On rotation or close the file is truncated to
+// the bytes written.
+// Until then the file has max_size bytes, the unwritten tail being zeros. After a
+// crash, the sink continues after the last non-zero byte.
+// Files are rotated as by rotating_file_sink: log.txt -> log.1.txt -> log.2.txt ...
+
+namespace spdlog {
+namespace details {
+
+// a file mapped at its full size, written at ranges reserved with an atomic cursor
+class mmap_segment
+{
+public:
+    mmap_segment(const filename_t &filename, size_t capacity, bool truncate)
+        : filename_{filename}
+    {
+        os::create_dir(os::dir_name(filename_));
+        fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        if (fd_ < 0)
+        {
+            throw_spdlog_ex("mmap_segment: failed opening file " + os::filename_to_str(filename_), errno);
+        }
+        struct stat st;
+        size_t size = ::fstat(fd_, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        capacity_ = (std::max)(capacity, size);
+
+        // allocate the blocks now: running out of space while copying to the mapping would raise SIGBUS
+        int rv = ::posix_fallocate(fd_, 0, static_cast<off_t>(capacity_));
+        if (rv != 0)
+        {
+            ::close(fd_);
+            throw_spdlog_ex("mmap_segment: failed allocating file " + os::filename_to_str(filename_), rv);
+        }
+        auto data = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw_spdlog_ex("mmap_segment: failed mapping file " + os::filename_to_str(filename_), err);
+        }
+        data_ = static_cast<char *>(data);
+
+        // continue after what the file holds: its size, or its last non-zero byte if it was not closed
+        size_t used = size;
+        while (used > 0 && data_[used - 1] == '\0')
+        {
+            used--;
+        }
+        cursor_.store(used);
+        end_.store(capacity_);
+    }
+
+    mmap_segment(const mmap_segment &) = delete;
+    mmap_segment &operator=(const mmap_segment &) = delete;
+
+    ~mmap_segment()
+    {
+        ::munmap(data_, capacity_);
+        (void)::ftruncate(fd_, static_cast<off_t>(used()));
+        ::close(fd_);
+    }
+
+    // copy the data to the next free range. false if it does not fit.
+    bool write(const char *data, size_t size)
+    {
+        size_t offset = cursor_.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size > capacity_)
+        {
+            // the first range that did not fit is where the written bytes end
+            size_t end = end_.load(std::memory_order_relaxed);
+            while (offset < end && !end_.compare_exchange_weak(end, offset, std::memory_order_relaxed))
+            {}
+            return false;
+        }
+        std::memcpy(data_ + offset, data, size);
+        return true;
+    }
+
+    size_t used() const
+    {
+        return (std::min)(cursor_.load(std::memory_order_relaxed), end_.load(std::memory_order_relaxed));
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    const filename_t &filename() const
+    {
+        return filename_;
+    }
+
+private:
+    filename_t filename_;
+    int fd_ = -1;
+    char *data_ = nullptr;
+    size_t capacity_ = 0;
+    std::atomic<size_t> cursor_{0};
+    std::atomic<size_t> end_{0};
+};
+} // namespace details
+
+namespace sinks {
+
+template<typename Mutex>
+class mmap_file_sink final : public sink
+{
+public:
+    mmap_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false)
+        : base_filename_(std::move(base_filename))
+        , max_size_(max_size)
+        , max_files_(max_files)
+        , formatter_{details::make_unique<spdlog::pattern_formatter>()}
+        , formatter_key_{formatter_->key()}
+    {
+        if (max_size == 0)
+        {
+            throw_spdlog_ex("mmap_file_sink constructor: max_size arg cannot be zero");
+        }
+        current_ = details::make_unique<details::mmap_segment>(base_filename_, max_size_, false);
+        segment_.store(current_.get());
+        if (rotate_on_open && current_->used() > 0)
+        {
+            rotate_(epoch_.load(), 0);
+        }
+    }
+
+    mmap_file_sink(const mmap_file_sink &) = delete;
+    mmap_file_sink &operator=(const mmap_file_sink &) = delete;
+
+    // a rotation always maps a new file under the base name
+    filename_t filename()
+    {
+        return base_filename_;
+    }
+
+    void log(const details::log_msg &msg) override
+    {
+        log_batch(&msg, 1);
+    }
+
+    // format outside of any lock, with a formatter of the pool
+    void log_batch(const details::log_msg *msgs, size_t count) override
+    {
+        size_t generation;
+        auto msg_formatter = acquire_formatter_(generation);
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (should_log(msgs[i].level))
+            {
+                formatted.clear();
+                msg_formatter->format(msgs[i], formatted);
+                write_(formatted.data(), formatted.size());
+            }
+        }
+        release_formatter_(std::move(msg_formatter), generation);
+    }
+
+    void log_formatted_batch(
+        const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key) override
+    {
+        bool same_formatter;
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            same_formatter = !formatter_key.empty() && formatter_key == formatter_key_;
+        }
+        if (!same_formatter)
+        {
+            log_batch(msgs, count);
+            return;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (should_log(msgs[i].level))
+            {
+                write_(formatted[i].buf.data(), formatted[i].buf.size());
+            }
+        }
+    }
+
+    // the records are in the page cache as soon as they are copied
+    void flush() override {}
+
+    void set_pattern(const std::string &pattern) override
+    {
+        set_formatter(details::make_unique<spdlog::pattern_formatter>(pattern));
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        formatter_ = std::move(sink_formatter);
+        formatter_key_ = formatter_->key();
+        free_formatters_.clear();
+        formatter_generation_++;
+    }
+
+private:
+    // count the calling thread among the writers of the current epoch, which may use segment_
+    size_t enter_()
+    {
+        for (;;)
+        {
+            size_t epoch = epoch_.load();
+            writers_[epoch & 1].fetch_add(1);
+            if (epoch_.load() == epoch)
+            {
+                return epoch;
+            }
+            writers_[epoch & 1].fetch_sub(1);
+        }
+    }
+
+    void leave_(size_t epoch)
+    {
+        writers_[epoch & 1].fetch_sub(1);
+    }
+
+    void write_(const char *data, size_t size)
+    {
+        for (;;)
+        {
+            size_t epoch = enter_();
+            bool written = segment_.load()->write(data, size);
+            leave_(epoch);
+            if (written)
+            {
+                return;
+            }
+            rotate_(epoch, size);
+        }
+    }
+
+    // replace the segment which was full in the epoch, unless another thread did already.
+    // the full segment is truncated and closed once the writers of its epoch are gone:
+    // a writer entering later sees the next epoch, and so the new segment.
+    void rotate_(size_t epoch, size_t record_size)
+    {
+        std::lock_guard<Mutex> rotation_lock(rotation_mutex_);
+        if (epoch_.load() != epoch)
+        {
+            return;
+        }
+        rename_files_();
+        if (max_files_ == 0)
+        {
+            // no backups: unlink the full file, so the new segment does not truncate the inode it still maps
+            (void)details::os::remove(base_filename_);
+        }
+        // a record larger than max_size gets a segment of its own size
+        auto segment = details::make_unique<details::mmap_segment>(base_filename_, (std::max)(max_size_, record_size), true);
+        auto full = std::move(current_);
+        current_ = std::move(segment);
+        segment_.store(current_.get());
+        epoch_.store(epoch + 1);
+        while (writers_[epoch & 1].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // log.3.txt -> delete, log.2.txt -> log.3.txt, log.1.txt -> log.2.txt, log.txt -> log.1.txt
+    void rename_files_()
+    {
+        using details::os::filename_to_str;
+        using details::os::path_exists;
+        using file_names = rotating_file_sink<details::null_mutex>;
+
+        for (auto i = max_files_; i > 0; --i)
+        {
+            filename_t src = file_names::calc_filename(base_filename_, i - 1);
+            if (!path_exists(src))
+            {
+                continue;
+            }
+            filename_t target = file_names::calc_filename(base_filename_, i);
+            (void)details::os::remove(target);
+            if (details::os::rename(src, target) != 0)
+            {
+                throw_spdlog_ex("mmap_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+            }
+        }
+    }
+
+    std::unique_ptr<spdlog::formatter> acquire_formatter_(size_t &generation)
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        generation = formatter_generation_;
+        if (free_formatters_.empty())
+        {
+            return formatter_->clone();
+        }
+        auto msg_formatter = std::move(free_formatters_.back());
+        free_formatters_.pop_back();
+        return msg_formatter;
+    }
+
+    void release_formatter_(std::unique_ptr<spdlog::formatter> msg_formatter, size_t generation)
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        if (generation == formatter_generation_)
+        {
+            free_formatters_.push_back(std::move(msg_formatter));
+        }
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+
+    // guards the formatters, held only to take or give back one
+    Mutex mutex_;
+    Mutex rotation_mutex_;
+
+    // current_ owns the segment the writers find in segment_, both replaced under rotation_mutex_.
+    // a rotation then starts the next epoch. the writers count themselves in the epoch they
+    // entered, of which only the current and the previous can be in use.
+    std::unique_ptr<details::mmap_segment> current_;
+    std::atomic<details::mmap_segment *> segment_{nullptr};
+    std::atomic<size_t> epoch_{0};
+    std::atomic<size_t> writers_[2] = {{0}, {0}};
+
+    // formatter_ is the prototype of the formatters used by the logging threads,
+    // which take one from free_formatters_ (or a new clone) and give it back after use
+    std::unique_ptr<spdlog::formatter> formatter_;
+    std::string formatter_key_;
+    std::vector<std::unique_ptr<spdlog::formatter>> free_formatters_;
+    size_t formatter_generation_ = 0;
+};
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_mt(
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+{
+    return Factory::template create<sinks::mmap_file_sink_mt>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_st(
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files, bool rotate_on_open = false)
+{
+    return Factory::template create<sinks::mmap_file_sink_st>(logger_name, filename, max_file_size, max_files, rotate_on_open);
+}
+
+} // namespace spdlog
@@ -19,17 +19,20 @@
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace spdlog {
 namespace sinks {
 
 template<typename Mutex>
 SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
-    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open, const file_event_handlers &event_handlers)
+    filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open, const file_event_handlers &event_handlers,
+    bool background_rotation)
     : base_filename_(std::move(base_filename))
     , max_size_(max_size)
     , max_files_(max_files)
     , file_helper_{event_handlers}
+    , background_rotation_(background_rotation)
 {
     if (max_size == 0)
     {
@@ -42,13 +45,58 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     }
     file_helper_.open(calc_filename(base_filename_, 0));
     current_size_ = file_helper_.size(); // expensive. called only once
+    if (background_rotation_ && max_files_ > 0)
+    {
+        recover_rotations_();
+    }
     if (rotate_on_open && current_size_ > 0)
     {
+#ifdef SPDLOG_NO_EXCEPTIONS
         rotate_();
+#else
+        // the helper thread may be running already, and the destructor would not join it
+        try
+        {
+            rotate_();
+        }
+        catch (...)
+        {
+            stop_rotation_thread_();
+            throw;
+        }
+#endif
         current_size_ = 0;
     }
 }
 
+template<typename Mutex>
+SPDLOG_INLINE rotating_file_sink<Mutex>::~rotating_file_sink()
+{
+    stop_rotation_thread_();
+}
+
+// let the helper thread finish the pending rotations
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::stop_rotation_thread_()
+{
+    if (rotation_thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(rotation_mutex_);
+            rotation_stop_ = true;
+        }
+        rotation_cv_.notify_all();
+        rotation_thread_.join();
+    }
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::wait_for_rotation()
+{
+    std::unique_lock<std::mutex> lock(rotation_mutex_);
+    rotation_cv_.wait(lock, [this] { return rotation_queue_.empty(); });
+}
+
 // calc filename according to index and file extension if exists.
 // e.g. calc_filename("logs/mylog.txt, 3) => "logs/mylog.3.txt".
 template<typename Mutex>
@@ -94,6 +142,58 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &m
     current_size_ = new_size;
 }
 
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_batch_(const details::log_msg *msgs, size_t count)
+{
+    memory_buf_t formatted;
+    write_batch_(msgs, count, [this, msgs, &formatted](size_t i) {
+        formatted.clear();
+        base_sink<Mutex>::formatter_->format(msgs[i], formatted);
+        return string_view_t{formatted.data(), formatted.size()};
+    });
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count)
+{
+    write_batch_(msgs, count, [formatted](size_t i) { return string_view_t{formatted[i].buf.data(), formatted[i].buf.size()}; });
+}
+
+// collect the batch into one buffer and write it at once.
+// the buffer is written out early only when a message of the batch needs a rotation.
+template<typename Mutex>
+template<typename MsgBytes>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::write_batch_(const details::log_msg *msgs, size_t count, MsgBytes &&msg_bytes)
+{
+    batch_.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!base_sink<Mutex>::should_log(msgs[i].level))
+        {
+            continue;
+        }
+        string_view_t formatted = msg_bytes(i);
+        auto new_size = current_size_ + batch_.size() + formatted.size();
+
+        // same rotation rule as in sink_it_()
+        if (new_size > max_size_)
+        {
+            file_helper_.write(batch_);
+            current_size_ += batch_.size();
+            batch_.clear();
+            file_helper_.flush();
+            if (file_helper_.size() > 0)
+            {
+                rotate_();
+                current_size_ = 0;
+            }
+        }
+        batch_.append(formatted.data(), formatted.data() + formatted.size());
+    }
+    file_helper_.write(batch_);
+    current_size_ += batch_.size();
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 {
@@ -111,6 +211,12 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
     using details::os::filename_to_str;
     using details::os::path_exists;
 
+    if (background_rotation_ && max_files_ > 0)
+    {
+        rotate_in_background_();
+        return;
+    }
+
     file_helper_.close();
     for (auto i = max_files_; i > 0; --i)
     {
@@ -138,6 +244,146 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_()
     file_helper_.reopen(true);
 }
 
+// log.txt -> log.rotating<n>.txt, then reopen log.txt.
+// the helper thread does the rest of the rotation, see shift_files_().
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_in_background_()
+{
+    using details::os::filename_to_str;
+
+    {
+        // more pending files would be shifted out anyway. keeps a name free, see rotating_filename_()
+        std::unique_lock<std::mutex> lock(rotation_mutex_);
+        rotation_cv_.wait(lock, [this] { return rotation_queue_.size() < max_files_; });
+    }
+    filename_t rotated = rotating_filename_(rotation_seq_++);
+
+    file_helper_.close();
+    if (!rename_file_(base_filename_, rotated))
+    {
+        // same workaround as in rotate_()
+        details::os::sleep_for_millis(100);
+        if (!rename_file_(base_filename_, rotated))
+        {
+            file_helper_.reopen(true);
+            current_size_ = 0;
+            throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(base_filename_) + " to " + filename_to_str(rotated), errno);
+        }
+    }
+    file_helper_.reopen(true);
+
+    {
+        std::lock_guard<std::mutex> lock(rotation_mutex_);
+        rotation_queue_.push_back(std::move(rotated));
+        if (!rotation_thread_.joinable())
+        {
+            rotation_thread_ = std::thread([this] { rotation_loop_(); });
+        }
+    }
+    rotation_cv_.notify_all();
+}
+
+// at most max_files files are pending, so the names cycle through max_files + 1 slots,
+// at least one of them free. the pending files follow a free slot in rotation order.
+template<typename Mutex>
+SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::rotating_filename_(std::size_t seq) const
+{
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    return fmt_lib::format(SPDLOG_FILENAME_T("{}.rotating{}{}"), basename, seq % (max_files_ + 1), ext);
+}
+
+// the files found are older than log.txt: the helper thread renames them first, oldest first
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::recover_rotations_()
+{
+    size_t slots = max_files_ + 1;
+    std::vector<bool> pending(slots);
+    size_t free_slot = slots - 1;
+    for (size_t i = 0; i < slots; i++)
+    {
+        pending[i] = details::os::path_exists(rotating_filename_(i));
+        if (!pending[i])
+        {
+            free_slot = i;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(rotation_mutex_);
+    for (size_t i = 1; i <= slots; i++)
+    {
+        size_t slot = (free_slot + i) % slots;
+        if (pending[slot])
+        {
+            rotation_queue_.push_back(rotating_filename_(slot));
+            rotation_seq_ = slot + 1;
+        }
+    }
+    if (!rotation_queue_.empty())
+    {
+        rotation_thread_ = std::thread([this] { rotation_loop_(); });
+    }
+}
+
+// runs until the sink is destroyed and all the pending rotations are done
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotation_loop_()
+{
+    std::unique_lock<std::mutex> lock(rotation_mutex_);
+    for (;;)
+    {
+        rotation_cv_.wait(lock, [this] { return rotation_stop_ || !rotation_queue_.empty(); });
+        if (rotation_queue_.empty())
+        {
+            return;
+        }
+        filename_t rotated = rotation_queue_.front();
+        lock.unlock();
+        shift_files_(rotated);
+        lock.lock();
+        rotation_queue_.pop_front();
+        rotation_cv_.notify_all();
+    }
+}
+
+// Rotate files:
+// log.2.txt -> log.3.txt
+// log.1.txt -> log.2.txt
+// log.rotating<n>.txt -> log.1.txt
+// there is nobody to report a failure to: the rotation is done as far as it can be,
+// and a moved aside file that cannot take its place is deleted.
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::shift_files_(const filename_t &rotated_filename)
+{
+    SPDLOG_TRY
+    {
+        for (auto i = max_files_; i > 1; --i)
+        {
+            filename_t src = calc_filename(base_filename_, i - 1);
+            if (!details::os::path_exists(src))
+            {
+                continue;
+            }
+            filename_t target = calc_filename(base_filename_, i);
+            if (!rename_file_(src, target))
+            {
+                details::os::sleep_for_millis(100);
+                (void)rename_file_(src, target);
+            }
+        }
+        filename_t target = calc_filename(base_filename_, 1);
+        if (!rename_file_(rotated_filename, target))
+        {
+            details::os::sleep_for_millis(100);
+            if (!rename_file_(rotated_filename, target))
+            {
+                (void)details::os::remove(rotated_filename);
+            }
+        }
+    }
+    SPDLOG_CATCH_STD
+}
+
 // delete the target if exists, and rename the src file  to target
 // return true on success, false otherwise.
 template<typename Mutex>
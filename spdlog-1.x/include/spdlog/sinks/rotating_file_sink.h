@@ -9,8 +9,11 @@
 #include <spdlog/details/synchronous_factory.h>
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
+#include <thread>
 
 namespace spdlog {
 namespace sinks {
@@ -18,17 +21,29 @@ namespace sinks {
 //
 // Rotating file sink based on size
 //
+// With background_rotation, a rotation only moves the full file aside and opens a
+// fresh one. The rename cascade (log.1.txt -> log.2.txt, ...) runs on a helper
+// thread, so the logging thread does not wait for max_files renames.
+// The files moved aside and not yet renamed by a previous run (e.g. after a crash)
+// are renamed in place when the sink is created, and count toward max_files.
+//
 template<typename Mutex>
 class rotating_file_sink final : public base_sink<Mutex>
 {
 public:
     rotating_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files, bool rotate_on_open = false,
-        const file_event_handlers &event_handlers = {});
+        const file_event_handlers &event_handlers = {}, bool background_rotation = false);
+    ~rotating_file_sink() override;
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
 
+    // wait until the helper thread has put the rotated files in place (background_rotation only)
+    void wait_for_rotation();
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *msgs, size_t count) override;
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override;
     void flush_() override;
 
 private:
@@ -39,15 +54,47 @@ private:
     // log.3.txt -> delete
     void rotate_();
 
+    // background_rotation: move the file aside, reopen it and let the helper thread shift the others
+    void rotate_in_background_();
+
+    // name of the n-th file moved aside: log.rotating<n % (max_files + 1)>.txt
+    filename_t rotating_filename_(std::size_t seq) const;
+
+    // queue the files a previous run moved aside but did not rename
+    void recover_rotations_();
+
+    // helper thread: shift log.1.txt.. up by one, then rename the moved aside file to log.1.txt
+    void rotation_loop_();
+    // finish the pending rotations and join the helper thread
+    void stop_rotation_thread_();
+    void shift_files_(const filename_t &rotated_filename);
+
     // delete the target if exists, and rename the src file  to target
     // return true on success, false otherwise.
     bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
 
+    // write the messages allowed by the sink level, rotating as needed.
+    // msg_bytes(i) returns the formatted bytes of msgs[i].
+    template<typename MsgBytes>
+    void write_batch_(const details::log_msg *msgs, size_t count, MsgBytes &&msg_bytes);
+
     filename_t base_filename_;
     std::size_t max_size_;
     std::size_t max_files_;
     std::size_t current_size_;
     details::file_helper file_helper_;
+    // batch buffer of write_batch_(), reused so that writing a batch does not allocate once it has grown
+    memory_buf_t batch_;
+
+    // background rotation. the queue holds the files moved aside, in rotation order.
+    // the front stays in the queue until the helper thread has renamed it.
+    bool background_rotation_;
+    std::size_t rotation_seq_ = 0;
+    std::mutex rotation_mutex_;
+    std::condition_variable rotation_cv_;
+    std::deque<filename_t> rotation_queue_;
+    bool rotation_stop_ = false;
+    std::thread rotation_thread_;
 };
 
 using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
@@ -61,18 +108,18 @@ using rotating_file_sink_st = rotating_file_sink<details::null_mutex>;
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> rotating_logger_mt(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
-    size_t max_files, bool rotate_on_open = false, const file_event_handlers &event_handlers = {})
+    size_t max_files, bool rotate_on_open = false, const file_event_handlers &event_handlers = {}, bool background_rotation = false)
 {
     return Factory::template create<sinks::rotating_file_sink_mt>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers, background_rotation);
 }
 
 template<typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> rotating_logger_st(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
-    size_t max_files, bool rotate_on_open = false, const file_event_handlers &event_handlers = {})
+    size_t max_files, bool rotate_on_open = false, const file_event_handlers &event_handlers = {}, bool background_rotation = false)
 {
     return Factory::template create<sinks::rotating_file_sink_st>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers, background_rotation);
 }
 } // namespace spdlog
 
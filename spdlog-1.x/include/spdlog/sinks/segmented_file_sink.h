@@ -0,0 +1,385 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/circular_q.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#    include <spdlog/details/windows_include.h>
+#else
+#    include <dirent.h>
+#    include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * Rotating file sink based on size, without renames.
+ * Each segment gets the next sequence number: log.000001.txt, log.000002.txt, ...
+ * A rotation opens the next segment and, if max_files > 0, deletes the oldest one,
+ * so its cost does not depend on max_files and open segments never change name.
+ * log.current.txt is a symlink to the active segment (not on Windows). On start,
+ * the sink appends to the segment it points to, and deletes the segments that no
+ * longer fit in max_files, including the ones left behind a gap in the numbering.
+ */
+template<typename Mutex>
+class segmented_file_sink final : public base_sink<Mutex>
+{
+public:
+    segmented_file_sink(filename_t base_filename, std::size_t max_size, std::size_t max_files = 0, const file_event_handlers &event_handlers = {})
+        : base_filename_(std::move(base_filename))
+        , max_size_(max_size)
+        , max_files_(max_files)
+        , file_helper_{event_handlers}
+    {
+        if (max_size == 0)
+        {
+            throw_spdlog_ex("segmented_file_sink: max_size arg cannot be zero");
+        }
+
+        seq_ = read_current_seq_();
+        if (seq_ == 0)
+        {
+            open_next_segment_();
+        }
+        else
+        {
+            file_helper_.open(calc_filename(base_filename_, seq_));
+            update_current_link_();
+        }
+        current_size_ = file_helper_.size(); // expensive. called only once
+
+        if (max_files_ > 0)
+        {
+            init_filenames_q_();
+        }
+    }
+
+    // calc segment filename according to the sequence number and file extension if exists.
+    // e.g. calc_filename("logs/mylog.txt", 3) => "logs/mylog.000003.txt".
+    static filename_t calc_filename(const filename_t &filename, std::size_t seq)
+    {
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(filename);
+        return fmt_lib::format(SPDLOG_FILENAME_T("{}.{:06}{}"), basename, seq, ext);
+    }
+
+    // e.g. current_link_filename("logs/mylog.txt") => "logs/mylog.current.txt".
+    static filename_t current_link_filename(const filename_t &filename)
+    {
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(filename);
+        return fmt_lib::format(SPDLOG_FILENAME_T("{}.current{}"), basename, ext);
+    }
+
+    filename_t filename()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.filename();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        write_(formatted.data(), formatted.size());
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                formatted.clear();
+                base_sink<Mutex>::formatter_->format(msgs[i], formatted);
+                write_(formatted.data(), formatted.size());
+            }
+        }
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                write_(formatted[i].buf.data(), formatted[i].buf.size());
+            }
+        }
+    }
+
+    void flush_() override
+    {
+        file_helper_.flush();
+    }
+
+private:
+    // same rotation rule as rotating_file_sink: rotate if the new estimated size exceeds
+    // max size and the real size > 0.
+    void write_(const char *data, size_t size)
+    {
+        auto new_size = current_size_ + size;
+        bool rotated = false;
+        if (new_size > max_size_)
+        {
+            file_helper_.flush();
+            if (file_helper_.size() > 0)
+            {
+                open_next_segment_();
+                new_size = size;
+                rotated = true;
+            }
+        }
+        file_helper_.write(data, size);
+        current_size_ = new_size;
+
+        // Do the cleaning only at the end because it might throw on failure.
+        if (rotated && max_files_ > 0)
+        {
+            delete_old_();
+        }
+    }
+
+    // open the segment after seq_, skipping the numbers of files that already exist
+    void open_next_segment_()
+    {
+        filename_t filename;
+        do
+        {
+            filename = calc_filename(base_filename_, ++seq_);
+        } while (details::os::path_exists(filename));
+        file_helper_.open(filename, true);
+        update_current_link_();
+    }
+
+    // point the current link to the active segment: a new link renamed over the old one
+    void update_current_link_()
+    {
+#ifndef _WIN32
+        using details::os::filename_to_str;
+
+        auto link = current_link_filename(base_filename_);
+        auto tmp_link = link + ".tmp";
+        auto target = segment_name_(seq_);
+        (void)details::os::remove(tmp_link);
+        if (::symlink(target.c_str(), tmp_link.c_str()) != 0 || details::os::rename(tmp_link, link) != 0)
+        {
+            throw_spdlog_ex("segmented_file_sink: failed updating " + filename_to_str(link), errno);
+        }
+#endif
+    }
+
+    // the sequence number of the segment the current link points to, 0 if none
+    std::size_t read_current_seq_() const
+    {
+#ifndef _WIN32
+        auto link = current_link_filename(base_filename_);
+        char target[4096];
+        auto n = ::readlink(link.c_str(), target, sizeof(target) - 1);
+        if (n <= 0)
+        {
+            return 0;
+        }
+        target[n] = '\0';
+        return parse_seq_(filename_t(target));
+#else
+        return 0;
+#endif
+    }
+
+    // the segment filename without its directory, as the link target
+    filename_t segment_name_(std::size_t seq) const
+    {
+        return file_name_(calc_filename(base_filename_, seq));
+    }
+
+    static filename_t file_name_(const filename_t &path)
+    {
+        auto dir = details::os::dir_name(path);
+        return dir.empty() ? path : path.substr(dir.size() + 1);
+    }
+
+    // the sequence number in a segment name without its directory, 0 if it is not one of ours.
+    // the seq is between the file name of the base and its extension.
+    std::size_t parse_seq_(const filename_t &name) const
+    {
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(file_name_(base_filename_));
+        auto prefix = basename + SPDLOG_FILENAME_T(".");
+        if (name.size() <= prefix.size() + ext.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+        {
+            return 0;
+        }
+        std::size_t seq = 0;
+        for (size_t i = prefix.size(); i < name.size() - ext.size(); i++)
+        {
+            if (name[i] < '0' || name[i] > '9')
+            {
+                return 0;
+            }
+            seq = seq * 10 + static_cast<std::size_t>(name[i] - '0');
+        }
+        return seq;
+    }
+
+    // the sequence numbers of the segments in the directory of the base filename, unsorted
+    std::vector<std::size_t> list_segments_() const
+    {
+        std::vector<std::size_t> seqs;
+        auto dir = details::os::dir_name(base_filename_);
+#ifdef _WIN32
+        auto pattern = (dir.empty() ? filename_t(SPDLOG_FILENAME_T(".")) : dir) + SPDLOG_FILENAME_T("\\*");
+#    ifdef SPDLOG_WCHAR_FILENAMES
+        WIN32_FIND_DATAW entry;
+        auto handle = ::FindFirstFileW(pattern.c_str(), &entry);
+#    else
+        WIN32_FIND_DATAA entry;
+        auto handle = ::FindFirstFileA(pattern.c_str(), &entry);
+#    endif
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return seqs;
+        }
+        do
+        {
+            auto seq = parse_seq_(entry.cFileName);
+            if (seq > 0)
+            {
+                seqs.push_back(seq);
+            }
+#    ifdef SPDLOG_WCHAR_FILENAMES
+        } while (::FindNextFileW(handle, &entry));
+#    else
+        } while (::FindNextFileA(handle, &entry));
+#    endif
+        ::FindClose(handle);
+#else
+        auto *d = ::opendir(dir.empty() ? "." : dir.c_str());
+        if (d == nullptr)
+        {
+            return seqs;
+        }
+        while (auto *entry = ::readdir(d))
+        {
+            auto seq = parse_seq_(entry->d_name);
+            if (seq > 0)
+            {
+                seqs.push_back(seq);
+            }
+        }
+        ::closedir(d);
+#endif
+        return seqs;
+    }
+
+    // the newest max_files - 1 segments preceding the active one, gaps in the numbering included.
+    // the older ones (e.g. after max_files was lowered) are deleted right away, since they would
+    // never reach the front of the queue.
+    // Throw spdlog_ex on failure to delete an old file.
+    void init_filenames_q_()
+    {
+        using details::os::filename_to_str;
+        using details::os::remove_if_exists;
+
+        std::vector<std::size_t> seqs;
+        for (auto seq : list_segments_())
+        {
+            if (seq < seq_)
+            {
+                seqs.push_back(seq);
+            }
+        }
+        std::sort(seqs.begin(), seqs.end());
+
+        auto keep = std::min(seqs.size(), max_files_ - 1);
+        auto first_kept = seqs.size() - keep;
+        for (size_t i = 0; i < first_kept; i++)
+        {
+            auto old_filename = calc_filename(base_filename_, seqs[i]);
+            if (remove_if_exists(old_filename) != 0)
+            {
+                throw_spdlog_ex("Failed removing segment file " + filename_to_str(old_filename), errno);
+            }
+        }
+
+        filenames_q_ = details::circular_q<filename_t>(max_files_);
+        for (size_t i = first_kept; i < seqs.size(); i++)
+        {
+            filenames_q_.push_back(calc_filename(base_filename_, seqs[i]));
+        }
+        filenames_q_.push_back(filename_t(file_helper_.filename()));
+    }
+
+    // Delete the oldest segment if there are max_files of them.
+    // Throw spdlog_ex on failure to delete the old file.
+    void delete_old_()
+    {
+        using details::os::filename_to_str;
+        using details::os::remove_if_exists;
+
+        filename_t current_file = file_helper_.filename();
+        if (filenames_q_.full())
+        {
+            auto old_filename = std::move(filenames_q_.front());
+            filenames_q_.pop_front();
+            bool ok = remove_if_exists(old_filename) == 0;
+            if (!ok)
+            {
+                filenames_q_.push_back(std::move(current_file));
+                throw_spdlog_ex("Failed removing segment file " + filename_to_str(old_filename), errno);
+            }
+        }
+        filenames_q_.push_back(std::move(current_file));
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    std::size_t current_size_ = 0;
+    std::size_t seq_ = 0;
+    details::file_helper file_helper_;
+    details::circular_q<filename_t> filenames_q_;
+};
+
+using segmented_file_sink_mt = segmented_file_sink<std::mutex>;
+using segmented_file_sink_st = segmented_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> segmented_logger_mt(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    size_t max_files = 0, const file_event_handlers &event_handlers = {})
+{
+    return Factory::template create<sinks::segmented_file_sink_mt>(logger_name, filename, max_file_size, max_files, event_handlers);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> segmented_logger_st(const std::string &logger_name, const filename_t &filename, size_t max_file_size,
+    size_t max_files = 0, const file_event_handlers &event_handlers = {})
+{
+    return Factory::template create<sinks::segmented_file_sink_st>(logger_name, filename, max_file_size, max_files, event_handlers);
+}
+} // namespace spdlog
@@ -0,0 +1,311 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Serial port (tty) sink, POSIX only.
+// Opens the device in raw mode with the given baud rate and a non-blocking fd.
+// Formatted messages are appended to a ring buffer, which is written out with as
+// few write() calls as the line accepts, so bursts are absorbed by the buffer
+// instead of stalling the caller (e.g. the async logger worker) on a slow line.
+// The bytes left in the buffer are written with the next message or on flush(),
+// so flush() should be called periodically to push out the tail of a burst when
+// logging goes quiet (AsyncLogger does it every serialFlushInterval).
+
+namespace spdlog {
+namespace sinks {
+
+// what to do with a message that does not fit in the ring buffer
+enum class serial_overflow_policy
+{
+    drop,  // discard the message and count it (see serial_sink::dropped_count())
+    block  // wait for the line to take enough bytes
+};
+
+struct serial_sink_config
+{
+    std::string device;
+    int baud_rate = 115200;
+    size_t buffer_size = 16 * 1024;
+    serial_overflow_policy overflow_policy = serial_overflow_policy::drop;
+
+    explicit serial_sink_config(std::string device_path, int baud = 115200)
+        : device{std::move(device_path)}
+        , baud_rate{baud}
+    {}
+};
+
+template<typename Mutex>
+class serial_sink final : public base_sink<Mutex>
+{
+public:
+    explicit serial_sink(serial_sink_config sink_config)
+        : config_{std::move(sink_config)}
+        , ring_(config_.buffer_size)
+    {
+        open_();
+    }
+
+    ~serial_sink() override
+    {
+        // give the line a moment to take what is left
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        SPDLOG_TRY
+        {
+            while (size_ > 0 && std::chrono::steady_clock::now() < deadline)
+            {
+                if (wait_writable_(10))
+                {
+                    write_pending_();
+                }
+            }
+        }
+        SPDLOG_CATCH_STD
+        ::close(fd_);
+    }
+
+    serial_sink(const serial_sink &) = delete;
+    serial_sink &operator=(const serial_sink &) = delete;
+
+    // number of messages discarded by serial_overflow_policy::drop
+    size_t dropped_count()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return dropped_;
+    }
+
+    // bytes waiting in the ring buffer
+    size_t pending_bytes()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return size_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        push_(formatted.data(), formatted.size());
+        write_pending_();
+    }
+
+    // queue the whole batch, then write it with as few calls as possible
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                formatted.clear();
+                base_sink<Mutex>::formatter_->format(msgs[i], formatted);
+                push_(formatted.data(), formatted.size());
+            }
+        }
+        write_pending_();
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                push_(formatted[i].buf.data(), formatted[i].buf.size());
+            }
+        }
+        write_pending_();
+    }
+
+    // write what the line takes now, without waiting
+    void flush_() override
+    {
+        write_pending_();
+    }
+
+private:
+    static speed_t to_speed_(int baud_rate)
+    {
+        switch (baud_rate)
+        {
+        case 1200:
+            return B1200;
+        case 2400:
+            return B2400;
+        case 4800:
+            return B4800;
+        case 9600:
+            return B9600;
+        case 19200:
+            return B19200;
+        case 38400:
+            return B38400;
+        case 57600:
+            return B57600;
+        case 115200:
+            return B115200;
+        case 230400:
+            return B230400;
+#ifdef B460800
+        case 460800:
+            return B460800;
+#endif
+#ifdef B921600
+        case 921600:
+            return B921600;
+#endif
+        default:
+            throw_spdlog_ex("serial_sink: unsupported baud rate " + std::to_string(baud_rate));
+        }
+    }
+
+    void open_()
+    {
+        if (config_.buffer_size == 0)
+        {
+            throw_spdlog_ex("serial_sink: buffer size must be greater than zero");
+        }
+        auto speed = to_speed_(config_.baud_rate);
+        fd_ = ::open(config_.device.c_str(), O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0)
+        {
+            throw_spdlog_ex("serial_sink: failed opening " + config_.device, errno);
+        }
+
+        termios tty;
+        if (::tcgetattr(fd_, &tty) != 0)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw_spdlog_ex("serial_sink: " + config_.device + " is not a tty", err);
+        }
+        ::cfmakeraw(&tty);
+        tty.c_cflag |= CLOCAL | CREAD;
+        ::cfsetispeed(&tty, speed);
+        ::cfsetospeed(&tty, speed);
+        if (::tcsetattr(fd_, TCSANOW, &tty) != 0)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw_spdlog_ex("serial_sink: failed configuring " + config_.device, err);
+        }
+    }
+
+    // append a message to the ring, applying the overflow policy if it does not fit
+    void push_(const char *data, size_t n)
+    {
+        if (n > ring_.size() - size_)
+        {
+            write_pending_();
+        }
+        if (n > ring_.size() - size_)
+        {
+            if (config_.overflow_policy == serial_overflow_policy::drop || n > ring_.size())
+            {
+                dropped_++;
+                return;
+            }
+            while (n > ring_.size() - size_)
+            {
+                wait_writable_(-1);
+                write_pending_();
+            }
+        }
+
+        size_t tail = (head_ + size_) % ring_.size();
+        size_t first = (std::min)(n, ring_.size() - tail);
+        std::memcpy(ring_.data() + tail, data, first);
+        std::memcpy(ring_.data(), data + first, n - first);
+        size_ += n;
+    }
+
+    // write as much of the ring as the line takes now: one writev() for both parts
+    void write_pending_()
+    {
+        while (size_ > 0)
+        {
+            iovec iov[2];
+            size_t first = (std::min)(size_, ring_.size() - head_);
+            iov[0].iov_base = ring_.data() + head_;
+            iov[0].iov_len = first;
+            iov[1].iov_base = ring_.data();
+            iov[1].iov_len = size_ - first;
+            auto written = ::writev(fd_, iov, iov[1].iov_len > 0 ? 2 : 1);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    return;
+                }
+                throw_spdlog_ex("serial_sink: failed writing to " + config_.device, errno);
+            }
+            head_ = (head_ + static_cast<size_t>(written)) % ring_.size();
+            size_ -= static_cast<size_t>(written);
+        }
+        head_ = 0;
+    }
+
+    // wait up to timeout_ms (-1: forever) for the line to take more bytes
+    bool wait_writable_(int timeout_ms)
+    {
+        pollfd pfd{fd_, POLLOUT, 0};
+        int rv = ::poll(&pfd, 1, timeout_ms);
+        if (rv < 0 && errno != EINTR)
+        {
+            throw_spdlog_ex("serial_sink: poll failed on " + config_.device, errno);
+        }
+        return rv > 0;
+    }
+
+    serial_sink_config config_;
+    int fd_ = -1;
+    std::vector<char> ring_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    size_t dropped_ = 0;
+};
+
+using serial_sink_mt = serial_sink<std::mutex>;
+using serial_sink_st = serial_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> serial_logger_mt(const std::string &logger_name, const sinks::serial_sink_config &config)
+{
+    return Factory::template create<sinks::serial_sink_mt>(logger_name, config);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> serial_logger_st(const std::string &logger_name, const sinks::serial_sink_config &config)
+{
+    return Factory::template create<sinks::serial_sink_st>(logger_name, config);
+}
+
+} // namespace spdlog
@@ -14,6 +14,23 @@ SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg
     return msg_level >= level_.load(std::memory_order_relaxed);
 }
 
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(const details::log_msg *msgs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i].level))
+        {
+            log(msgs[i]);
+        }
+    }
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_formatted_batch(
+    const details::log_msg *msgs, const details::formatted_msg *, size_t count, const std::string &)
+{
+    log_batch(msgs, count);
+}
+
 SPDLOG_INLINE void spdlog::sinks::sink::set_level(level::level_enum log_level)
 {
     level_.store(log_level, std::memory_order_relaxed);
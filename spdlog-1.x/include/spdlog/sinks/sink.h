@@ -14,6 +14,14 @@ class SPDLOG_API sink
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+    // log a batch of messages (e.g. drained from the async queue at once).
+    // the default implementation calls log() for each message allowed by the sink level.
+    virtual void log_batch(const details::log_msg *msgs, size_t count);
+    // log a batch of messages the logger already formatted (formatted[i] belongs to msgs[i];
+    // messages no sink took at the batch start are left out). sinks whose formatter has the given key write
+    // the formatted bytes as they are. the default implementation calls log_batch().
+    virtual void log_formatted_batch(
+        const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count, const std::string &formatter_key);
     virtual void flush() = 0;
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
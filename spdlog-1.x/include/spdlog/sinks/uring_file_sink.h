@@ -0,0 +1,661 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#    if __has_include(<linux/io_uring.h>)
+#        include <linux/io_uring.h>
+#        include <sys/mman.h>
+#        include <sys/syscall.h>
+#        define SPDLOG_URING_AVAILABLE
+#    endif
+#endif
+
+// File sink writing through io_uring, POSIX only.
+// Messages are copied into one of a few fixed buffers. A full buffer is queued for
+// writing, and the caller (e.g. the async logger worker) goes on filling the next
+// buffer while the kernel writes the previous one, so page cache or writeback stalls
+// only block it once all the buffers are full.
+// The file is opened in append mode like basic_file_sink, so several processes can
+// log to the same file. To keep the buffers in order, one write is in flight at a
+// time: the next queued buffer is submitted when it completes.
+// flush() submits the queued buffers and waits for all the writes to complete.
+// Without io_uring (not Linux, a kernel without IORING_OP_WRITE, or disabled by
+// seccomp) the full buffers are written with write(), which still saves the
+// per-message stdio calls. If io_uring fails later, the queued buffers are written
+// with write() and the writer keeps using it.
+// rotating_uring_file_sink rotates the file by size like rotating_file_sink: the
+// rotation waits for the writes of the full file, renames the files and opens a new
+// file with a new ring.
+
+namespace spdlog {
+namespace details {
+
+class uring_file_writer
+{
+public:
+    uring_file_writer(const filename_t &filename, bool truncate, size_t buffers, size_t buffer_size, bool use_uring)
+        : filename_{filename}
+        , buffers_(buffers)
+    {
+        if (buffers == 0 || buffer_size == 0)
+        {
+            throw_spdlog_ex("uring_file_writer: buffers and buffer_size must be greater than zero");
+        }
+        for (auto &buf : buffers_)
+        {
+            buf.data.resize(buffer_size);
+        }
+
+        os::create_dir(os::dir_name(filename_));
+        fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        if (fd_ < 0)
+        {
+            throw_spdlog_ex("uring_file_writer: failed opening file " + os::filename_to_str(filename_), errno);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) == 0)
+        {
+            size_ = static_cast<size_t>(st.st_size);
+        }
+
+        if (use_uring)
+        {
+            setup_ring_();
+        }
+    }
+
+    uring_file_writer(const uring_file_writer &) = delete;
+    uring_file_writer &operator=(const uring_file_writer &) = delete;
+
+    ~uring_file_writer()
+    {
+        SPDLOG_TRY
+        {
+            flush();
+        }
+        SPDLOG_CATCH_STD
+        close_ring_();
+        ::close(fd_);
+    }
+
+    void write(const char *data, size_t size)
+    {
+        size_ += size;
+        while (size > 0)
+        {
+            auto &buf = buffers_[current_];
+            size_t n = (std::min)(size, buf.data.size() - buf.size);
+            std::memcpy(buf.data.data() + buf.size, data, n);
+            buf.size += n;
+            data += n;
+            size -= n;
+            if (buf.size == buf.data.size())
+            {
+                queue_current_();
+            }
+        }
+    }
+
+    // queue the current buffer and wait for all the writes
+    void flush()
+    {
+        queue_current_();
+        while (in_flight_ > 0)
+        {
+            reap_(true);
+        }
+    }
+
+    bool uses_uring() const
+    {
+        return ring_fd_ >= 0;
+    }
+
+    // the file size on open plus the bytes written since, buffered ones included.
+    // the writes of other processes appending to the file are not counted.
+    size_t size() const
+    {
+        return size_;
+    }
+
+    const filename_t &filename() const
+    {
+        return filename_;
+    }
+
+private:
+    // io_uring_enter() attempts to submit a write before giving up on io_uring
+    static const int max_submit_attempts = 8;
+
+    struct buffer
+    {
+        std::vector<char> data;
+        size_t size = 0;
+        bool queued = false;    // full, waiting for its turn to be written
+        bool in_flight = false; // submitted to io_uring
+    };
+
+    // queue the current buffer for writing and move on to the next buffer,
+    // waiting for it if it is not written yet
+    void queue_current_()
+    {
+        auto &buf = buffers_[current_];
+        if (buf.size == 0)
+        {
+            return;
+        }
+        if (uses_uring())
+        {
+            buf.queued = true;
+            submit_next_();
+        }
+        else
+        {
+            write_all_(buf, 0);
+            buf.size = 0;
+        }
+
+        current_ = (current_ + 1) % buffers_.size();
+        while (buffers_[current_].queued || buffers_[current_].in_flight)
+        {
+            reap_(true);
+        }
+    }
+
+    // submit the oldest queued buffer, unless a write is in flight
+    void submit_next_()
+    {
+        if (in_flight_ == 0 && buffers_[next_].queued)
+        {
+            size_t index = next_;
+            next_ = (next_ + 1) % buffers_.size();
+            submit_(index);
+        }
+    }
+
+    // write the rest of the buffer from done bytes on, synchronously
+    void write_all_(const buffer &buf, size_t done)
+    {
+        while (done < buf.size)
+        {
+            auto written = ::write(fd_, buf.data.data() + done, buf.size - done);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw_spdlog_ex("uring_file_writer: failed writing to file " + os::filename_to_str(filename_), errno);
+            }
+            done += static_cast<size_t>(written);
+        }
+    }
+
+    // io_uring failed: close the ring, write whatever was queued with write() in order and keep using it.
+    // a write the kernel completed without reporting it yet is written again.
+    void fall_back_to_write_()
+    {
+        close_ring_();
+        in_flight_ = 0;
+        for (size_t i = 0; i < buffers_.size(); i++)
+        {
+            // the buffer in flight comes first, then the queued ones in order
+            auto &buf = buffers_[(next_ + buffers_.size() - 1 + i) % buffers_.size()];
+            if (buf.in_flight || buf.queued)
+            {
+                buf.in_flight = false;
+                buf.queued = false;
+                write_all_(buf, 0);
+                buf.size = 0;
+            }
+        }
+    }
+
+#ifdef SPDLOG_URING_AVAILABLE
+    // one write in flight at a time, so the smallest ring will do
+    void setup_ring_()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+        if (ring_fd < 0)
+        {
+            return;
+        }
+        if (!write_supported_(ring_fd))
+        {
+            ::close(ring_fd);
+            return;
+        }
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = false;
+#    ifdef IORING_FEAT_SINGLE_MMAP
+        single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#    endif
+        if (single_mmap)
+        {
+            sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_
+                               : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        ring_fd_ = ring_fd;
+        if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED)
+        {
+            close_ring_();
+            return;
+        }
+
+        auto sq = static_cast<char *>(sq_ring_);
+        auto cq = static_cast<char *>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    // IORING_OP_WRITE came with 5.6, and so did IORING_REGISTER_PROBE: on 5.1-5.5 the ring
+    // exists, but every write would fail with EINVAL
+    static bool write_supported_(int ring_fd)
+    {
+#    if defined(IO_URING_OP_SUPPORTED) && defined(__NR_io_uring_register)
+        const unsigned ops = IORING_OP_WRITE + 1;
+        std::vector<std::uint64_t> mem((sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op) + 7) / 8, 0);
+        auto probe = reinterpret_cast<io_uring_probe *>(mem.data());
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, ops) < 0)
+        {
+            return false;
+        }
+        return probe->last_op >= IORING_OP_WRITE && (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) != 0;
+#    else
+        (void)ring_fd;
+        return false;
+#    endif
+    }
+
+    void close_ring_()
+    {
+        if (ring_fd_ < 0)
+        {
+            return;
+        }
+        if (sqes_ != nullptr && sqes_ != MAP_FAILED)
+        {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+        {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED)
+        {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+
+    // queue a write of the buffer at the end of the file and submit it
+    void submit_(size_t index)
+    {
+        auto &buf = buffers_[index];
+        unsigned tail = *sq_tail_;
+        unsigned slot = tail & sq_mask_;
+        auto sqe = static_cast<io_uring_sqe *>(sqes_) + slot;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<unsigned long long>(buf.data.data());
+        sqe->len = static_cast<unsigned>(buf.size);
+        sqe->off = static_cast<unsigned long long>(-1); // the file position, the end with O_APPEND
+        sqe->user_data = index;
+        sq_array_[slot] = slot;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        buf.queued = false;
+        buf.in_flight = true;
+        in_flight_++;
+
+        for (int attempt = 1; ::syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0; attempt++)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // no other write is in flight to wait for, so retry with a short backoff.
+            // the write was never submitted, so flush() would wait for it forever.
+            if ((errno != EAGAIN && errno != EBUSY) || attempt == max_submit_attempts)
+            {
+                fall_back_to_write_();
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100 << attempt));
+        }
+    }
+
+    // handle the completed write, waiting for it if wait is true, and submit the next queued buffer.
+    // a short write is finished with write(), a failed one as well unless io_uring itself is unusable.
+    void reap_(bool wait)
+    {
+        unsigned head = *cq_head_;
+        if (wait && head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+        {
+            if (::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+            {
+                fall_back_to_write_();
+                return;
+            }
+        }
+
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            auto &cqe = cqes_[head & cq_mask_];
+            if (cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP)
+            {
+                // the kernel does not take this write at all (e.g. the file system does not support it)
+                fall_back_to_write_();
+                return;
+            }
+            auto &buf = buffers_[static_cast<size_t>(cqe.user_data)];
+            size_t done = cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0;
+            buf.in_flight = false;
+            in_flight_--;
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            write_all_(buf, done);
+            buf.size = 0;
+        }
+        submit_next_();
+    }
+#else
+    void setup_ring_() {}
+    void close_ring_() {}
+    void submit_(size_t) {}
+    void reap_(bool) {}
+#endif
+
+    filename_t filename_;
+    int fd_ = -1;
+    size_t size_ = 0;
+    std::vector<buffer> buffers_;
+    size_t current_ = 0;
+    size_t next_ = 0; // the next buffer to submit
+    size_t in_flight_ = 0;
+
+    int ring_fd_ = -1;
+#ifdef SPDLOG_URING_AVAILABLE
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    void *sqes_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+#endif
+};
+} // namespace details
+
+namespace sinks {
+
+template<typename Mutex>
+class uring_file_sink final : public base_sink<Mutex>
+{
+public:
+    static const size_t default_buffers = 4;
+    static const size_t default_buffer_size = 64 * 1024;
+
+    explicit uring_file_sink(const filename_t &filename, bool truncate = false, size_t buffers = default_buffers,
+        size_t buffer_size = default_buffer_size, bool use_uring = true)
+        : writer_{filename, truncate, buffers, buffer_size, use_uring}
+    {}
+
+    const filename_t &filename() const
+    {
+        return writer_.filename();
+    }
+
+    // false if the writes fall back to write()
+    bool uses_uring() const
+    {
+        return writer_.uses_uring();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        writer_.write(formatted.data(), formatted.size());
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                formatted.clear();
+                base_sink<Mutex>::formatter_->format(msgs[i], formatted);
+                writer_.write(formatted.data(), formatted.size());
+            }
+        }
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                writer_.write(formatted[i].buf.data(), formatted[i].buf.size());
+            }
+        }
+    }
+
+    void flush_() override
+    {
+        writer_.flush();
+    }
+
+private:
+    details::uring_file_writer writer_;
+};
+
+using uring_file_sink_mt = uring_file_sink<std::mutex>;
+using uring_file_sink_st = uring_file_sink<details::null_mutex>;
+
+template<typename Mutex>
+class rotating_uring_file_sink final : public base_sink<Mutex>
+{
+public:
+    rotating_uring_file_sink(filename_t base_filename, size_t max_size, size_t max_files,
+        size_t buffers = uring_file_sink<Mutex>::default_buffers, size_t buffer_size = uring_file_sink<Mutex>::default_buffer_size,
+        bool use_uring = true)
+        : base_filename_(std::move(base_filename))
+        , max_size_(max_size)
+        , max_files_(max_files)
+        , buffers_(buffers)
+        , buffer_size_(buffer_size)
+        , use_uring_(use_uring)
+    {
+        if (max_size == 0)
+        {
+            throw_spdlog_ex("rotating_uring_file_sink constructor: max_size arg cannot be zero");
+        }
+        writer_ = details::make_unique<details::uring_file_writer>(base_filename_, false, buffers_, buffer_size_, use_uring_);
+    }
+
+    const filename_t &filename() const
+    {
+        return base_filename_;
+    }
+
+    // false if the writes fall back to write()
+    bool uses_uring()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return writer_->uses_uring();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        write_(formatted.data(), formatted.size());
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                formatted.clear();
+                base_sink<Mutex>::formatter_->format(msgs[i], formatted);
+                write_(formatted.data(), formatted.size());
+            }
+        }
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                write_(formatted[i].buf.data(), formatted[i].buf.size());
+            }
+        }
+    }
+
+    void flush_() override
+    {
+        writer_->flush();
+    }
+
+private:
+    // same rotation rule as rotating_file_sink: rotate if the new size exceeds max size and the file is not empty
+    void write_(const char *data, size_t size)
+    {
+        if (writer_->size() + size > max_size_ && writer_->size() > 0)
+        {
+            rotate_();
+        }
+        writer_->write(data, size);
+    }
+
+    // log.txt -> log.1.txt, log.1.txt -> log.2.txt, ... the last one is deleted.
+    // a writer which fell back to write() is not given io_uring again.
+    void rotate_()
+    {
+        using details::os::filename_to_str;
+        using details::os::path_exists;
+        using file_names = rotating_file_sink<details::null_mutex>;
+
+        writer_->flush();
+        use_uring_ = use_uring_ && writer_->uses_uring();
+        writer_.reset();
+        for (auto i = max_files_; i > 0; --i)
+        {
+            filename_t src = file_names::calc_filename(base_filename_, i - 1);
+            if (!path_exists(src))
+            {
+                continue;
+            }
+            filename_t target = file_names::calc_filename(base_filename_, i);
+            (void)details::os::remove(target);
+            if (details::os::rename(src, target) != 0)
+            {
+                // truncate the log file anyway to prevent it to grow beyond its limit
+                writer_ = details::make_unique<details::uring_file_writer>(base_filename_, true, buffers_, buffer_size_, use_uring_);
+                throw_spdlog_ex(
+                    "rotating_uring_file_sink: failed renaming " + filename_to_str(src) + " to " + filename_to_str(target), errno);
+            }
+        }
+        writer_ = details::make_unique<details::uring_file_writer>(base_filename_, true, buffers_, buffer_size_, use_uring_);
+    }
+
+    filename_t base_filename_;
+    size_t max_size_;
+    size_t max_files_;
+    size_t buffers_;
+    size_t buffer_size_;
+    bool use_uring_;
+    std::unique_ptr<details::uring_file_writer> writer_;
+};
+
+using rotating_uring_file_sink_mt = rotating_uring_file_sink<std::mutex>;
+using rotating_uring_file_sink_st = rotating_uring_file_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> uring_logger_mt(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::uring_file_sink_mt>(logger_name, filename, truncate);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> uring_logger_st(const std::string &logger_name, const filename_t &filename, bool truncate = false)
+{
+    return Factory::template create<sinks::uring_file_sink_st>(logger_name, filename, truncate);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> rotating_uring_logger_mt(
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files)
+{
+    return Factory::template create<sinks::rotating_uring_file_sink_mt>(logger_name, filename, max_file_size, max_files);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> rotating_uring_logger_st(
+    const std::string &logger_name, const filename_t &filename, size_t max_file_size, size_t max_files)
+{
+    return Factory::template create<sinks::rotating_uring_file_sink_st>(logger_name, filename, max_file_size, max_files);
+}
+
+} // namespace spdlog
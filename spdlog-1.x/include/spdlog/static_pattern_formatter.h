@@ -0,0 +1,383 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Pattern formatter compiled from a pattern fixed at compile time.
+// The pattern is spelled as a list of items, e.g. "[%H:%M:%S] %v" is
+//
+//   using my_formatter = static_pattern_formatter<text<'['>, flag<'H'>, text<':'>, flag<'M'>, text<':'>,
+//       flag<'S'>, text<']', ' '>, flag<'v'>>;
+//
+// format() expands the items inline: no flag_formatter objects, no virtual call
+// per flag and no padding support. The leading date/time items are rendered once
+// a second and copied for the rest of it. The output is the same as pattern_formatter's
+// for pattern(), and so is key(), so both can share renderings (see formatter::key()).
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/formatter.h>
+#include <spdlog/pattern_formatter.h>
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+
+namespace spdlog {
+namespace details {
+template<char Flag, bool NeedsTime>
+struct static_flag_base
+{
+    static constexpr bool needs_time = NeedsTime;
+    static constexpr bool per_second = NeedsTime;
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern.push_back('%');
+        pattern.push_back(Flag);
+    }
+};
+
+template<bool... Values>
+struct static_any_of;
+
+template<>
+struct static_any_of<>
+{
+    static constexpr bool value = false;
+};
+
+template<bool First, bool... Rest>
+struct static_any_of<First, Rest...>
+{
+    static constexpr bool value = First || static_any_of<Rest...>::value;
+};
+
+// splits the items into the leading date/time part (items with per_second set),
+// which is the same for the whole second, and the rest.
+template<bool InPrefix, typename... Items>
+struct static_items
+{
+    static void format_prefix(const log_msg &, const std::tm &, memory_buf_t &) {}
+    static void format_rest(const log_msg &, const std::tm &, memory_buf_t &) {}
+};
+
+template<bool InPrefix, typename First, typename... Rest>
+struct static_items<InPrefix, First, Rest...>
+{
+    static constexpr bool in_prefix = InPrefix && First::per_second;
+
+    static void format_prefix(const log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        if (in_prefix)
+        {
+            First::format(msg, tm_time, dest);
+            static_items<in_prefix, Rest...>::format_prefix(msg, tm_time, dest);
+        }
+    }
+
+    static void format_rest(const log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        if (!in_prefix)
+        {
+            First::format(msg, tm_time, dest);
+        }
+        static_items<in_prefix, Rest...>::format_rest(msg, tm_time, dest);
+    }
+};
+} // namespace details
+
+namespace static_pattern {
+
+// literal text
+template<char... Chars>
+struct text
+{
+    static_assert(sizeof...(Chars) > 0, "static_pattern: empty text");
+    static constexpr bool needs_time = false;
+    // constant, so it may be cached along with the date/time around it
+    static constexpr bool per_second = true;
+
+    static void format(const details::log_msg &, const std::tm &, memory_buf_t &dest)
+    {
+        static const char str[] = {Chars...};
+        dest.append(str, str + sizeof...(Chars));
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        static const char str[] = {Chars...};
+        for (char ch : str)
+        {
+            if (ch == '%')
+            {
+                pattern.push_back('%');
+            }
+            pattern.push_back(ch);
+        }
+    }
+};
+
+// a pattern flag, see the specializations below for the supported ones
+template<char Flag>
+struct flag
+{
+    static_assert(Flag != Flag, "static_pattern: unsupported pattern flag");
+};
+
+// logger name
+template<>
+struct flag<'n'> : details::static_flag_base<'n', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        details::fmt_helper::append_string_view(msg.logger_name, dest);
+    }
+};
+
+// level
+template<>
+struct flag<'l'> : details::static_flag_base<'l', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        details::fmt_helper::append_string_view(level::to_string_view(msg.level), dest);
+    }
+};
+
+// short level
+template<>
+struct flag<'L'> : details::static_flag_base<'L', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        const char *level_name = level::to_short_c_str(msg.level);
+        dest.append(level_name, level_name + std::strlen(level_name));
+    }
+};
+
+// MM/DD/YY
+template<>
+struct flag<'D'> : details::static_flag_base<'D', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_mon + 1, dest);
+        dest.push_back('/');
+        details::fmt_helper::pad2(tm_time.tm_mday, dest);
+        dest.push_back('/');
+        details::fmt_helper::pad2(tm_time.tm_year % 100, dest);
+    }
+};
+
+// year - 4 digit
+template<>
+struct flag<'Y'> : details::static_flag_base<'Y', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::append_int(tm_time.tm_year + 1900, dest);
+    }
+};
+
+// month 01-12
+template<>
+struct flag<'m'> : details::static_flag_base<'m', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_mon + 1, dest);
+    }
+};
+
+// day of month 01-31
+template<>
+struct flag<'d'> : details::static_flag_base<'d', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_mday, dest);
+    }
+};
+
+// hours in 24 format 00-23
+template<>
+struct flag<'H'> : details::static_flag_base<'H', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_hour, dest);
+    }
+};
+
+// minutes 00-59
+template<>
+struct flag<'M'> : details::static_flag_base<'M', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_min, dest);
+    }
+};
+
+// seconds 00-59
+template<>
+struct flag<'S'> : details::static_flag_base<'S', true>
+{
+    static void format(const details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        details::fmt_helper::pad2(tm_time.tm_sec, dest);
+    }
+};
+
+// milliseconds
+template<>
+struct flag<'e'> : details::static_flag_base<'e', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        auto millis = details::fmt_helper::time_fraction<std::chrono::milliseconds>(msg.time);
+        details::fmt_helper::pad3(static_cast<uint32_t>(millis.count()), dest);
+    }
+};
+
+// microseconds
+template<>
+struct flag<'f'> : details::static_flag_base<'f', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        auto micros = details::fmt_helper::time_fraction<std::chrono::microseconds>(msg.time);
+        details::fmt_helper::pad6(static_cast<size_t>(micros.count()), dest);
+    }
+};
+
+// nanoseconds
+template<>
+struct flag<'F'> : details::static_flag_base<'F', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        auto ns = details::fmt_helper::time_fraction<std::chrono::nanoseconds>(msg.time);
+        details::fmt_helper::pad9(static_cast<size_t>(ns.count()), dest);
+    }
+};
+
+// thread id
+template<>
+struct flag<'t'> : details::static_flag_base<'t', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        details::fmt_helper::append_int(msg.thread_id, dest);
+    }
+};
+
+// message text
+template<>
+struct flag<'v'> : details::static_flag_base<'v', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        details::fmt_helper::append_string_view(msg.payload, dest);
+    }
+};
+
+// start of the color range
+template<>
+struct flag<'^'> : details::static_flag_base<'^', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        msg.color_range_start = dest.size();
+    }
+};
+
+// end of the color range
+template<>
+struct flag<'$'> : details::static_flag_base<'$', false>
+{
+    static void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        msg.color_range_end = dest.size();
+    }
+};
+} // namespace static_pattern
+
+template<typename... Items>
+class static_pattern_formatter final : public formatter
+{
+public:
+    explicit static_pattern_formatter(
+        pattern_time_type time_type = pattern_time_type::local, std::string eol = details::os::default_eol)
+        : eol_(std::move(eol))
+        , pattern_time_type_(time_type)
+        , key_(pattern_formatter(pattern(), time_type, eol_).key())
+        , last_log_secs_(0)
+    {
+        std::memset(&cached_tm_, 0, sizeof(cached_tm_));
+    }
+
+    static_pattern_formatter(const static_pattern_formatter &other) = delete;
+    static_pattern_formatter &operator=(const static_pattern_formatter &other) = delete;
+
+    // the equivalent runtime pattern
+    static std::string pattern()
+    {
+        std::string rv;
+        using expander = int[];
+        (void)expander{0, (Items::append_pattern(rv), 0)...};
+        return rv;
+    }
+
+    std::unique_ptr<formatter> clone() const override
+    {
+        return details::make_unique<static_pattern_formatter>(pattern_time_type_, eol_);
+    }
+
+    std::string key() const override
+    {
+        return key_;
+    }
+
+    void format(const details::log_msg &msg, memory_buf_t &dest) override
+    {
+        if (needs_time)
+        {
+            const auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+            if (secs != last_log_secs_ || cached_prefix_.size() == 0)
+            {
+                auto time = log_clock::to_time_t(msg.time);
+                cached_tm_ = pattern_time_type_ == pattern_time_type::local ? details::os::localtime(time)
+                                                                            : details::os::gmtime(time);
+                last_log_secs_ = secs;
+                // the leading date/time part, e.g. "[%D %H:%M:%S:", is rendered once a second
+                cached_prefix_.clear();
+                items::format_prefix(msg, cached_tm_, cached_prefix_);
+            }
+            dest.append(cached_prefix_.begin(), cached_prefix_.end());
+        }
+        items::format_rest(msg, cached_tm_, dest);
+        details::fmt_helper::append_string_view(eol_, dest);
+    }
+
+private:
+    static constexpr bool needs_time = details::static_any_of<Items::needs_time...>::value;
+    // without date/time flags nothing is cached
+    using items = details::static_items<needs_time, Items...>;
+
+    std::string eol_;
+    pattern_time_type pattern_time_type_;
+    std::string key_;
+    std::tm cached_tm_;
+    std::chrono::seconds last_log_secs_;
+    memory_buf_t cached_prefix_;
+};
+
+template<typename... Items>
+constexpr bool static_pattern_formatter<Items...>::needs_time;
+
+} // namespace spdlog
@@ -1,8 +1,14 @@
 #include "includes.h"
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+#ifndef _WIN32
+#    include "spdlog/sinks/ansicolor_sink.h"
+#endif
 #include "test_sink.h"
 
+#include <future>
+
 #define TEST_FILENAME "test_logs/async_test.log"
 
 TEST_CASE("basic async test ", "[async]")
@@ -146,6 +152,761 @@ TEST_CASE("multi threads", "[async]")
     REQUIRE(test_sink->flush_counter() == n_threads);
 }
 
+TEST_CASE("batched dispatch", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    size_t queue_size = 1024;
+    size_t messages = 512;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        // keep the worker busy with the first message, so the rest piles up in the queue
+        test_sink->set_delay(std::chrono::milliseconds(100));
+        logger->info("Hello message #0");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        test_sink->set_delay(std::chrono::milliseconds::zero());
+        for (size_t i = 1; i < messages; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+    REQUIRE(test_sink->batch_counter() < messages / 2);
+    REQUIRE(test_sink->lines()[99] == "Hello message #99");
+}
+
+TEST_CASE("deferred formatting", "[async]")
+{
+    enum class color
+    {
+        red,
+        green
+    };
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        logger->log_deferred(spdlog::level::info, "int {} double {:.2f} char {}", 42, 3.14159, 'x');
+        logger->log_deferred(spdlog::level::warn, "enum {} bool {}", static_cast<int>(color::green), true);
+        logger->log_deferred(spdlog::level::debug, "filtered {}", 1);
+        logger->log_deferred(spdlog::level::info, "{:08x}", 0xbeefu);
+    }
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 3);
+    REQUIRE(lines[0] == "int 42 double 3.14 char x");
+    REQUIRE(lines[1] == "enum 1 bool true");
+    REQUIRE(lines[2] == "0000beef");
+}
+
+TEST_CASE("deferred formatting rejects runtime format strings", "[async]")
+{
+    // the worker formats after the call returned, so the format string is queued by pointer
+    static_assert(!std::is_constructible<spdlog::deferred_format_string_t<int>, decltype(SPDLOG_FMT_RUNTIME(std::string()))>::value,
+        "runtime format strings must not be deferred");
+    static_assert(std::is_constructible<spdlog::deferred_format_string_t<int>, const char (&)[6]>::value, "literals can be deferred");
+}
+
+TEST_CASE("deferred formatting backtrace", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        logger->enable_backtrace(4);
+        logger->log_deferred(spdlog::level::debug, "traced {}", 7);
+        logger->dump_backtrace();
+    }
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == 3);
+    REQUIRE(lines[1] == "traced 7");
+}
+
+TEST_CASE("deferred hex dump", "[async]")
+{
+    std::vector<unsigned char> frame(100);
+    for (size_t i = 0; i < frame.size(); i++)
+    {
+        frame[i] = static_cast<unsigned char>(i * 7);
+    }
+    for (auto queue_type : {spdlog::async_queue_type::mpmc_blocking, spdlog::async_queue_type::byte_ring})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%v");
+        {
+            auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, queue_type);
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+            logger->log_hex_deferred(spdlog::level::info, "frame {}", frame.data(), frame.size());
+            logger->log_hex_deferred<16>(spdlog::level::warn, "{:Xa}", frame.data(), frame.size());
+            logger->log_hex_deferred(spdlog::level::debug, "filtered {}", frame.data(), frame.size());
+            logger->log_hex_deferred(spdlog::level::info, "empty {}", frame.data(), 0);
+        }
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines[0] == fmt::format("frame {}", spdlog::to_hex(frame)));
+        REQUIRE(lines[1] == fmt::format("{:Xa}", spdlog::to_hex(frame, 16)));
+        REQUIRE(lines[2] == fmt::format("empty {}", spdlog::to_hex(frame.data(), frame.data())));
+    }
+}
+
+TEST_CASE("lockfree queue", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t queue_size = 128;
+    size_t messages = 256;
+    size_t n_threads = 10;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, spdlog::async_queue_type::mpsc_lockfree);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("lockfree queue discard policy", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t queue_size = 4;
+    size_t messages = 1024;
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, spdlog::async_queue_type::mpsc_lockfree);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() < messages);
+    REQUIRE(tp->overrun_counter() > 0);
+}
+
+TEST_CASE("per thread queue", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t queue_size = 64;
+    size_t messages = 256;
+    size_t n_threads = 10;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, spdlog::async_queue_type::per_thread_spsc);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("per thread queue single worker", "[async]")
+{
+    REQUIRE_THROWS_AS(spdlog::details::thread_pool(64, 2, spdlog::async_queue_type::per_thread_spsc), spdlog::spdlog_ex);
+}
+
+TEST_CASE("per thread queue ring capacity", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    std::promise<void> started;
+    auto start = started.get_future().share();
+    {
+        // the worker waits until the rings are checked
+        auto tp = std::make_shared<spdlog::details::thread_pool>(
+            8192, 1, [start] { start.wait(); }, [] {}, spdlog::async_queue_type::per_thread_spsc, 0,
+            spdlog::async_wait_strategy::blocking, 16);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        for (int i = 0; i < 16; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        // the ring of this thread holds 16 messages, not q_max_items
+        REQUIRE(tp->queue_size() == 16);
+        REQUIRE(tp->queue_load() == 1.0f);
+        started.set_value();
+    }
+    REQUIRE(test_sink->msg_counter() == 16);
+}
+
+TEST_CASE("per thread queue rejects overrun_oldest", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, spdlog::async_queue_type::per_thread_spsc);
+        REQUIRE_THROWS_AS(spdlog::async_logger("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest), spdlog::spdlog_ex);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::shed_by_level);
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() == 1);
+}
+
+TEST_CASE("byte ring queue", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%n %l %v");
+    size_t messages = 256;
+    size_t n_threads = 4;
+    std::string large(3000, 'x');
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, spdlog::async_queue_type::byte_ring);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        logger->warn("{}", large);
+        logger->log_deferred(spdlog::level::info, "deferred {}", 42);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++)
+        {
+            threads.emplace_back([logger, messages, &large] {
+                for (size_t j = 0; j < messages; j++)
+                {
+                    logger->info("{} #{}", large.substr(0, j * 10), j);
+                }
+            });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads + 2);
+    REQUIRE(test_sink->flush_counter() == 1);
+    auto lines = test_sink->lines();
+    REQUIRE(lines[0] == "as warning " + large);
+    REQUIRE(lines[1] == "as info deferred 42");
+}
+
+TEST_CASE("byte ring queue discard policy", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 1024;
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, spdlog::async_queue_type::byte_ring);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() < messages);
+    REQUIRE(tp->overrun_counter() > 0);
+}
+
+TEST_CASE("wait strategies", "[async]")
+{
+    using spdlog::async_queue_type;
+    using spdlog::async_wait_strategy;
+    size_t messages = 1024;
+    size_t n_threads = 4;
+    for (auto queue_type : {async_queue_type::mpmc_blocking, async_queue_type::mpsc_lockfree, async_queue_type::byte_ring})
+    {
+        for (auto wait_strategy : {async_wait_strategy::spin_park, async_wait_strategy::spin_yield, async_wait_strategy::busy_spin})
+        {
+            auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+            {
+                auto tp = std::make_shared<spdlog::details::thread_pool>(128, 2, queue_type, 0, wait_strategy);
+                REQUIRE(tp->wait_strategy() == wait_strategy);
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < n_threads; i++)
+                {
+                    threads.emplace_back([logger, messages] {
+                        for (size_t j = 0; j < messages; j++)
+                        {
+                            logger->info("Hello message #{}", j);
+                        }
+                    });
+                }
+                for (auto &t : threads)
+                {
+                    t.join();
+                }
+                logger->flush();
+            }
+            REQUIRE(test_sink->msg_counter() == messages * n_threads);
+            REQUIRE(test_sink->flush_counter() == 1);
+        }
+    }
+}
+
+TEST_CASE("spin park wakes idle worker", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(
+        128, 1, spdlog::async_queue_type::mpsc_lockfree, 16, spdlog::async_wait_strategy::spin_park);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+    // let the worker run out of spins and park, then make sure each kind of post wakes it up
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    logger->info("first");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    logger->error("severe");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    logger->log_deferred(spdlog::level::info, "deferred {}", 1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (test_sink->msg_counter() < 3 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(test_sink->msg_counter() == 3);
+}
+
+TEST_CASE("priority lane", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 98;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1, spdlog::async_queue_type::mpmc_blocking, 16);
+        REQUIRE(tp->has_priority_lane());
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("info #{}", i);
+        }
+        logger->critical("critical");
+        logger->info("last");
+        logger->flush();
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages + 2);
+    REQUIRE(test_sink->flush_counter() == 1);
+    auto lines = test_sink->lines();
+    REQUIRE(lines.back() == "last");
+    // the critical message overtakes the info messages still queued behind the first batch
+    auto critical_pos = std::find(lines.begin(), lines.end(), "critical");
+    REQUIRE(critical_pos != lines.end());
+    REQUIRE(critical_pos - lines.begin() <= static_cast<std::ptrdiff_t>(spdlog::details::default_async_batch_size));
+}
+
+TEST_CASE("priority lane wakes idle worker", "[async]")
+{
+    for (auto strategy : {spdlog::async_wait_strategy::blocking, spdlog::async_wait_strategy::spin_park,
+             spdlog::async_wait_strategy::spin_yield})
+    {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, spdlog::async_queue_type::mpsc_lockfree, 16, strategy);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+        // let the worker park on the empty main queue
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        logger->error("error");
+        for (int i = 0; i < 200 && test_sink->msg_counter() == 0; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(test_sink->msg_counter() == 1);
+    }
+}
+
+TEST_CASE("priority lane does not wake busy worker", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(200));
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, spdlog::async_queue_type::mpmc_blocking, 16);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+
+    // the worker is busy writing the first message, so the errors take no main queue slots
+    logger->info("info");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int i = 0; i < 10; i++)
+    {
+        logger->error("error #{}", i);
+    }
+    REQUIRE(tp->queue_load() == 0.0f);
+    logger->flush();
+    REQUIRE(test_sink->msg_counter() == 11);
+}
+
+TEST_CASE("shed by level", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    test_sink->set_delay(std::chrono::milliseconds(2));
+    size_t messages = 30;
+    std::shared_ptr<spdlog::async_logger> logger;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(8, 1);
+        logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::shed_by_level);
+        logger->set_shed_watermarks(0.5f, 0.75f);
+        for (size_t i = 0; i < messages; i++)
+        {
+            logger->info("info #{}", i);
+            logger->warn("warn #{}", i);
+            logger->error("error #{}", i);
+        }
+        logger->flush();
+    }
+
+    auto lines = test_sink->lines();
+    auto count_prefix = [&lines](const std::string &prefix) {
+        return static_cast<size_t>(
+            std::count_if(lines.begin(), lines.end(), [&prefix](const std::string &line) { return line.find(prefix) == 0; }));
+    };
+    REQUIRE(logger->shed_counter(spdlog::level::info) > 0);
+    REQUIRE(logger->shed_counter(spdlog::level::err) == 0);
+    REQUIRE(count_prefix("error #") == messages);
+    REQUIRE(count_prefix("info #") + logger->shed_counter(spdlog::level::info) == messages);
+    REQUIRE(count_prefix("warn #") + logger->shed_counter(spdlog::level::warn) == messages);
+    // the flush forces out the report of the messages shed since the last one
+    REQUIRE(ends_with(lines.back(), "messages shed"));
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("logger released when unused", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+    {
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        for (int i = 0; i < 100; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        // the destructor waits for the pool to process the messages
+    }
+    REQUIRE(test_sink->msg_counter() == 100);
+}
+
+TEST_CASE("logger table reuses released entries", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    for (size_t threads : {1, 3})
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, threads);
+        std::vector<std::shared_ptr<spdlog::async_logger>> alive;
+        for (int i = 0; i < 5000; i++)
+        {
+            auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+            logger->info("Hello message #{}", i);
+            if (i % 1000 == 0)
+            {
+                alive.push_back(std::move(logger));
+            }
+        }
+    }
+    REQUIRE(test_sink->msg_counter() == 10000);
+}
+
+TEST_CASE("logger released with overrun", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(4, 2);
+    auto other = std::make_shared<spdlog::async_logger>("other", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    std::atomic<bool> done{false};
+    std::thread flood([&other, &done] {
+        while (!done)
+        {
+            other->info("flood");
+        }
+    });
+    for (int i = 0; i < 20; i++)
+    {
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+        logger->info("Hello message #{}", i);
+    }
+    done = true;
+    flood.join();
+}
+
+namespace {
+// drops its reference to a logger when it writes a message, on the worker thread
+class releasing_sink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    std::shared_ptr<spdlog::async_logger> held;
+    std::atomic<bool> released{false};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override
+    {
+        held.reset();
+        released = true;
+    }
+    void flush_() override {}
+};
+} // namespace
+
+TEST_CASE("logger released on a worker thread", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto releasing = std::make_shared<releasing_sink>();
+    for (size_t threads : {1, 3})
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(1024, threads);
+        auto releaser = std::make_shared<spdlog::async_logger>("releaser", releasing, tp, spdlog::async_overflow_policy::block);
+        for (int round = 0; round < 20; round++)
+        {
+            releasing->released = false;
+            releasing->held = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+            for (int i = 0; i < 50; i++)
+            {
+                releasing->held->info("Hello message #{}", i);
+            }
+            // the other workers write the messages they took before the release completes
+            releaser->info("release");
+            while (!releasing->released)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    REQUIRE(test_sink->msg_counter() == 2 * 20 * 50);
+}
+
+TEST_CASE("logger clone registers itself", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%n %v");
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+        logger->info("first");
+        auto cloned = logger->clone("cloned");
+        cloned->info("second");
+        logger->info("third");
+    }
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"as first", "cloned second", "as third"});
+}
+
+TEST_CASE("logger outlives its pool", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 2);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, spdlog::async_overflow_policy::block);
+    size_t errors = 0;
+    logger->set_error_handler([&errors](const std::string &) { errors++; });
+    logger->info("before");
+    tp.reset();
+    REQUIRE(test_sink->msg_counter() == 1);
+
+    // the pool detached the logger: logging fails instead of posting
+    REQUIRE_THROWS_AS(logger->info("after"), spdlog::spdlog_ex);
+    REQUIRE_THROWS_AS(logger->flush(), spdlog::spdlog_ex);
+    logger->info("after {}", 1);
+    REQUIRE(errors == 1);
+    REQUIRE(test_sink->msg_counter() == 1);
+    logger.reset();
+}
+
+TEST_CASE("log during shutdown", "[async]")
+{
+    spdlog::init_thread_pool(64, 2);
+    auto logger = spdlog::create_async<spdlog::sinks::test_sink_mt>("as");
+    auto test_sink = std::static_pointer_cast<spdlog::sinks::test_sink_mt>(logger->sinks()[0]);
+    std::atomic<size_t> errors{0};
+    logger->set_error_handler([&errors](const std::string &) { errors++; });
+
+    std::atomic<size_t> attempts{0};
+    std::thread writer([&] {
+        while (errors == 0)
+        {
+            logger->info("Hello message #{}", attempts++);
+        }
+    });
+    while (attempts < 100)
+    {
+        std::this_thread::yield();
+    }
+
+    // the pool goes while the writer logs: every message is either written or reported
+    spdlog::shutdown();
+    writer.join();
+    REQUIRE(errors == 1);
+    REQUIRE(test_sink->msg_counter() == attempts - 1);
+    logger.reset();
+}
+
+TEST_CASE("shared formatting", "[async]")
+{
+    auto first = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto second = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto other = std::make_shared<spdlog::sinks::test_sink_mt>();
+    second->set_level(spdlog::level::warn);
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", spdlog::sinks_init_list{first, second, other}, tp);
+        logger->set_shared_formatting(true);
+        logger->set_pattern("%n %l %v");
+        other->set_pattern("%v");
+        logger->info("one");
+        logger->warn("two");
+        logger->log_deferred(spdlog::level::err, "three {}", 3);
+        logger->flush();
+    }
+    REQUIRE(first->formatted_batch_counter() > 0);
+    REQUIRE(second->formatted_batch_counter() > 0);
+    REQUIRE(other->formatted_batch_counter() == 0);
+    REQUIRE(first->lines() == std::vector<std::string>{"as info one", "as warning two", "as error three 3"});
+    REQUIRE(second->lines() == std::vector<std::string>{"as warning two", "as error three 3"});
+    REQUIRE(other->lines() == std::vector<std::string>{"one", "two", "three 3"});
+}
+
+TEST_CASE("shared formatting multi-workers", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t messages = 1000;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 3);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        logger->set_shared_formatting(true);
+        logger->set_pattern("%n %v");
+        for (size_t i = 0; i < messages; i++)
+        {
+            // each worker formats with its own copy of the formatter, and picks up a new one
+            if (i == messages / 2)
+            {
+                logger->set_pattern("%v");
+            }
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->formatted_batch_counter() > 0);
+    auto lines = test_sink->lines();
+    for (auto &line : lines)
+    {
+        REQUIRE(line.find("Hello message #") != std::string::npos);
+    }
+}
+
+TEST_CASE("shared formatting to files", "[async]")
+{
+    prepare_logdir();
+    std::string basic_filename = "test_logs/shared_basic.log";
+    std::string rotating_filename = "test_logs/shared_rotating.log";
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto basic_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(SPDLOG_FILENAME_T("test_logs/shared_basic.log"), true);
+        auto rotating_sink =
+            std::make_shared<spdlog::sinks::rotating_file_sink_mt>(SPDLOG_FILENAME_T("test_logs/shared_rotating.log"), 1024 * 1024, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", spdlog::sinks_init_list{basic_sink, rotating_sink}, tp);
+        logger->set_shared_formatting(true);
+        logger->set_pattern("[%n] [%^%l%$] %v");
+        for (int i = 0; i < 100; i++)
+        {
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+    }
+    require_message_count(basic_filename, 100);
+    REQUIRE(file_contents(basic_filename) == file_contents(rotating_filename));
+    REQUIRE(ends_with(file_contents(basic_filename), fmt::format("[as] [info] Hello message #99{}", spdlog::details::os::default_eol)));
+}
+
+#ifndef _WIN32
+TEST_CASE("shared formatting keeps color ranges", "[async]")
+{
+    prepare_logdir();
+    std::string filename = "test_logs/shared_color.log";
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    auto target = std::fopen(filename.c_str(), "wb");
+    REQUIRE(target != nullptr);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+        auto color_sink = std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_nullmutex>>(
+            target, spdlog::color_mode::always);
+        // the second sink formats on its own and must not disturb the shared color range
+        auto plain_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        auto logger = std::make_shared<spdlog::async_logger>("as", spdlog::sinks_init_list{test_sink, plain_sink, color_sink}, tp);
+        logger->set_shared_formatting(true);
+        logger->set_pattern("[%^%l%$] %v");
+        plain_sink->set_pattern("%^%v%$");
+        logger->info("hello");
+    }
+    std::fclose(target);
+    REQUIRE(test_sink->formatted_batch_counter() > 0);
+    REQUIRE(file_contents(filename) == fmt::format("[\033[32minfo\033[m] hello{}", spdlog::details::os::default_eol));
+}
+#endif
+
+namespace {
+// lowers the level of another sink while the logger fans out a batch, like a set_level() from another thread
+class level_lowering_sink : public spdlog::sinks::sink
+{
+public:
+    explicit level_lowering_sink(std::shared_ptr<spdlog::sinks::sink> target)
+        : target_(std::move(target))
+    {}
+
+    void log(const spdlog::details::log_msg &) override {}
+    void log_formatted_batch(
+        const spdlog::details::log_msg *, const spdlog::details::formatted_msg *, size_t, const std::string &) override
+    {
+        target_->set_level(spdlog::level::trace);
+    }
+    void flush() override {}
+    void set_pattern(const std::string &) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    std::shared_ptr<spdlog::sinks::sink> target_;
+};
+} // namespace
+
+TEST_CASE("shared formatting with a sink level lowered", "[async]")
+{
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_level(spdlog::level::warn);
+    auto lowering_sink = std::make_shared<level_lowering_sink>(test_sink);
+    lowering_sink->set_level(spdlog::level::warn);
+    std::promise<void> started;
+    auto start = started.get_future().share();
+    {
+        // the worker waits until both messages are queued, so they are in one batch
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, [start] { start.wait(); }, [] {});
+        auto logger = std::make_shared<spdlog::async_logger>("as", spdlog::sinks_init_list{lowering_sink, test_sink}, tp);
+        logger->set_shared_formatting(true);
+        logger->set_pattern("%v");
+        logger->info("one");
+        logger->warn("two");
+        started.set_value();
+        logger->flush();
+    }
+    // the info message was not formatted for the batch, so the sink does not get it as an empty line
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"two"});
+}
+
 TEST_CASE("to_file", "[async]")
 {
     prepare_logdir();
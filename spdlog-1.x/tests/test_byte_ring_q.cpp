@@ -0,0 +1,108 @@
+#include "includes.h"
+#include "spdlog/details/byte_ring_q.h"
+
+using std::chrono::milliseconds;
+
+static void enqueue_string(spdlog::details::byte_ring_queue &q, const std::string &s)
+{
+    q.enqueue(s.size(), [&s](char *dest) { std::memcpy(dest, s.data(), s.size()); });
+}
+
+static std::vector<std::string> dequeue_strings(spdlog::details::byte_ring_queue &q, size_t max_records)
+{
+    std::vector<std::string> rv;
+    q.dequeue_bulk_for(max_records, milliseconds::zero(), [&rv](const char *data, size_t size) { rv.emplace_back(data, size); });
+    return rv;
+}
+
+TEST_CASE("byte ring dequeue-empty-nowait", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(256);
+    REQUIRE(dequeue_strings(q, 1).empty());
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("byte ring variable length records", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(1024);
+    enqueue_string(q, "a");
+    enqueue_string(q, std::string(300, 'b'));
+    enqueue_string(q, "");
+    enqueue_string(q, "ccc");
+    REQUIRE(q.size() == 4);
+    // size prefix plus the payload padded to 8 bytes
+    REQUIRE(q.used_bytes() == (8 + 8) + (8 + 304) + 8 + (8 + 8));
+    REQUIRE(q.approx_used_bytes() == q.used_bytes());
+
+    auto records = dequeue_strings(q, 10);
+    REQUIRE(records == std::vector<std::string>{"a", std::string(300, 'b'), "", "ccc"});
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.used_bytes() == 0);
+    REQUIRE(q.approx_used_bytes() == 0);
+}
+
+TEST_CASE("byte ring wraps around", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(128);
+    for (int i = 0; i < 100; i++)
+    {
+        auto s = std::string(static_cast<size_t>(i % 50), static_cast<char>('a' + i % 26));
+        enqueue_string(q, s);
+        auto records = dequeue_strings(q, 1);
+        REQUIRE(records.size() == 1);
+        REQUIRE(records[0] == s);
+    }
+    REQUIRE(q.used_bytes() == 0);
+}
+
+TEST_CASE("byte ring full queue", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(64);
+    REQUIRE(q.enqueue_if_have_room(24, [](char *dest) { std::memset(dest, 'x', 24); }));
+    REQUIRE(q.enqueue_if_have_room(24, [](char *dest) { std::memset(dest, 'y', 24); }));
+    REQUIRE_FALSE(q.enqueue_if_have_room(1, [](char *dest) { *dest = 'z'; }));
+
+    q.enqueue_nowait(1, [](char *dest) { *dest = 'z'; });
+    REQUIRE(q.overrun_counter() == 1);
+    REQUIRE(dequeue_strings(q, 10) == std::vector<std::string>{std::string(24, 'y'), "z"});
+}
+
+TEST_CASE("byte ring record too large", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(64);
+    REQUIRE_THROWS_AS(enqueue_string(q, std::string(64, 'x')), spdlog::spdlog_ex);
+}
+
+TEST_CASE("byte ring multi threads", "[byte_ring_q]")
+{
+    spdlog::details::byte_ring_queue q(512);
+    size_t n_threads = 4;
+    size_t messages = 1000;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&q, t, messages] {
+            for (size_t i = 0; i < messages; i++)
+            {
+                enqueue_string(q, std::to_string(t) + ":" + std::string(i % 70, 'x'));
+            }
+        });
+    }
+
+    std::vector<size_t> received(n_threads);
+    size_t total = 0;
+    while (total < n_threads * messages)
+    {
+        total += q.dequeue_bulk_for(16, milliseconds(100), [&received](const char *data, size_t size) {
+            std::string s(data, size);
+            auto t = static_cast<size_t>(s[0] - '0');
+            REQUIRE(s.size() == 2 + received[t] % 70);
+            received[t]++;
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(q.size() == 0);
+}
@@ -0,0 +1,132 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/durable_file_sink.h"
+
+#define DURABLE_LOG "test_logs/durable_log"
+
+TEST_CASE("durable_file_sink", "[durable_file_sink]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<spdlog::sinks::durable_file_sink_mt>(
+        SPDLOG_FILENAME_T(DURABLE_LOG), true, spdlog::level::critical, std::chrono::milliseconds(20));
+    spdlog::logger logger("logger", sink);
+    logger.set_pattern("%v");
+
+    // records below the durability level are not committed
+    logger.info("Test message");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(sink->commit_count() == 0);
+
+    // records arriving within the commit window share one fdatasync
+    std::uint64_t sequence = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        sequence = sink->next_durable_sequence();
+        logger.log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Critical message", sequence);
+    }
+    REQUIRE(sink->wait_durable(sequence, std::chrono::seconds(5)));
+    REQUIRE(sink->commit_count() >= 1);
+    REQUIRE(sink->commit_count() < 10);
+    require_message_count(DURABLE_LOG, 101);
+}
+
+TEST_CASE("durable_file_sink threads", "[durable_file_sink]")
+{
+    prepare_logdir();
+    // the window is long enough for the threads woken by a commit to log their next records
+    auto sink = std::make_shared<spdlog::sinks::durable_file_sink_mt>(
+        SPDLOG_FILENAME_T(DURABLE_LOG), true, spdlog::level::critical, std::chrono::milliseconds(50));
+    spdlog::logger logger("logger", sink);
+
+    const int n_threads = 4;
+    const int rounds = 5;
+    std::atomic<int> acknowledged{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < rounds; i++)
+            {
+                auto sequence = sink->next_durable_sequence();
+                logger.log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Critical message", sequence);
+                if (sink->wait_durable(sequence, std::chrono::seconds(5)))
+                {
+                    acknowledged++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(acknowledged == n_threads * rounds);
+    // a commit per record would make n_threads * rounds commits
+    REQUIRE(sink->commit_count() >= static_cast<size_t>(rounds));
+    REQUIRE(sink->commit_count() <= static_cast<size_t>(n_threads * rounds / 2));
+}
+
+TEST_CASE("durable_file_sink mixed records", "[durable_file_sink]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<spdlog::sinks::durable_file_sink_mt>(SPDLOG_FILENAME_T(DURABLE_LOG), true);
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("as", sink, tp, spdlog::async_overflow_policy::block);
+
+    // a plain critical record is committed, but does not stand for the awaited one
+    logger->critical("Plain message");
+    auto sequence = sink->next_durable_sequence();
+    logger->set_level(spdlog::level::off);
+    logger->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Dropped message", sequence);
+    REQUIRE_FALSE(sink->wait_durable(sequence, std::chrono::milliseconds(50)));
+    REQUIRE(sink->commit_count() >= 1);
+
+    // awaited records among plain ones, from several threads
+    logger->set_level(spdlog::level::trace);
+    std::vector<std::thread> threads;
+    std::atomic<int> acknowledged{0};
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10; i++)
+            {
+                logger->critical("Plain message");
+                auto durable_sequence = sink->next_durable_sequence();
+                logger->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Durable message", durable_sequence);
+                if (sink->wait_durable(durable_sequence, std::chrono::seconds(5)))
+                {
+                    acknowledged++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(acknowledged == 40);
+    logger->flush();
+    require_message_count(DURABLE_LOG, 81);
+}
+
+TEST_CASE("durable_file_sink async", "[durable_file_sink]")
+{
+    prepare_logdir();
+    auto sink = std::make_shared<spdlog::sinks::durable_file_sink_mt>(SPDLOG_FILENAME_T(DURABLE_LOG), true);
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("as", sink, tp, spdlog::async_overflow_policy::block);
+
+    auto sequence = sink->next_durable_sequence();
+    logger->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Critical message", sequence);
+    REQUIRE(sink->wait_durable(sequence, std::chrono::seconds(5)));
+    require_message_count(DURABLE_LOG, 1);
+
+    // a record the logger drops is never acknowledged
+    logger->set_level(spdlog::level::off);
+    sequence = sink->next_durable_sequence();
+    logger->log_sequenced(spdlog::source_loc{}, spdlog::level::critical, "Dropped message", sequence);
+    REQUIRE_FALSE(sink->wait_durable(sequence, std::chrono::milliseconds(50)));
+}
@@ -99,6 +99,331 @@ TEST_CASE("rotating_file_logger2", "[rotating_logger]]")
     REQUIRE(get_filesize(ROTATING_LOG ".1") <= max_size);
 }
 
+TEST_CASE("simple_file_logger batch", "[simple_logger]]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename);
+    sink->set_pattern("%v");
+    sink->set_level(spdlog::level::info);
+
+    std::vector<spdlog::details::log_msg> msgs;
+    msgs.emplace_back("logger", spdlog::level::info, "Test message 1");
+    msgs.emplace_back("logger", spdlog::level::debug, "Filtered message");
+    msgs.emplace_back("logger", spdlog::level::warn, "Test message 2");
+    sink->log_batch(msgs.data(), msgs.size());
+    sink->flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(SIMPLE_LOG) == spdlog::fmt_lib::format("Test message 1{}Test message 2{}", default_eol, default_eol));
+}
+
+TEST_CASE("rotating_file_logger batch", "[rotating_logger]]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(basename, max_size, 2);
+    sink->set_pattern("%v");
+
+    // 100 messages of 20 bytes (with eol) in one batch: rotates in the middle of the batch
+    std::vector<spdlog::details::log_msg> msgs(100, spdlog::details::log_msg("logger", spdlog::level::info, "Test message 0000"));
+    sink->log_batch(msgs.data(), msgs.size());
+    sink->flush();
+
+    REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
+    REQUIRE(get_filesize(ROTATING_LOG ".1") <= max_size);
+    REQUIRE(get_filesize(ROTATING_LOG ".1") > max_size / 2);
+}
+
+TEST_CASE("rotating_file_logger background", "[rotating_logger]]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(basename, max_size, 3, false, spdlog::file_event_handlers{}, true);
+    spdlog::logger logger("logger", sink);
+    logger.set_pattern("%v");
+
+    for (int i = 0; i < 1000; i++)
+    {
+        logger.info("Test message {:04}", i);
+    }
+    logger.flush();
+    sink->wait_for_rotation();
+
+    // the moved aside files are all in place: log, log.1, log.2, log.3
+    REQUIRE(count_files("test_logs") == 4);
+    auto first_message = [](const std::string &filename) { return std::stoi(file_contents(filename).substr(13, 4)); };
+    auto last_message = [](const std::string &filename) {
+        auto contents = file_contents(filename);
+        auto line = contents.rfind("Test message ");
+        return std::stoi(contents.substr(line + 13, 4));
+    };
+    REQUIRE(last_message(ROTATING_LOG) == 999);
+    REQUIRE(last_message(ROTATING_LOG ".1") + 1 == first_message(ROTATING_LOG));
+    REQUIRE(last_message(ROTATING_LOG ".2") + 1 == first_message(ROTATING_LOG ".1"));
+    REQUIRE(last_message(ROTATING_LOG ".3") + 1 == first_message(ROTATING_LOG ".2"));
+    REQUIRE(get_filesize(ROTATING_LOG ".3") <= max_size);
+}
+
+TEST_CASE("rotating_file_logger background recovery", "[rotating_logger]]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    auto write_file = [](const std::string &filename, const std::string &contents) {
+        std::ofstream(filename) << contents;
+    };
+
+    // a run with 3 files stopped before renaming two moved aside files: the names of 3 files
+    // cycle through 4 slots, the older one is in slot 3, the newer in slot 0
+    write_file(ROTATING_LOG ".1", "previous");
+    write_file(ROTATING_LOG ".rotating3", "older");
+    write_file(ROTATING_LOG ".rotating0", "newer");
+    write_file(ROTATING_LOG, "current");
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(basename, 1024, 3, false, spdlog::file_event_handlers{}, true);
+        sink->wait_for_rotation();
+    }
+
+    REQUIRE(count_files("test_logs") == 4);
+    REQUIRE(file_contents(ROTATING_LOG) == "current");
+    REQUIRE(file_contents(ROTATING_LOG ".1") == "newer");
+    REQUIRE(file_contents(ROTATING_LOG ".2") == "older");
+    REQUIRE(file_contents(ROTATING_LOG ".3") == "previous");
+}
+
+TEST_CASE("rotating_file_logger background recovery throws", "[rotating_logger]]")
+{
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    std::ofstream(ROTATING_LOG ".rotating0") << "moved aside";
+    std::ofstream(ROTATING_LOG) << "current";
+
+    // the recovered file starts the helper thread, then reopening the file in rotate_on_open fails
+    size_t opens = 0;
+    spdlog::file_event_handlers handlers;
+    handlers.before_open = [&opens](const spdlog::filename_t &) {
+        if (++opens == 2)
+        {
+            throw spdlog::spdlog_ex("reopen failed");
+        }
+    };
+    REQUIRE_THROWS_AS(spdlog::sinks::rotating_file_sink_mt(basename, 1024, 3, true, handlers, true), spdlog::spdlog_ex);
+}
+
+#ifndef _WIN32
+TEST_CASE("segmented_file_logger", "[segmented_logger]]")
+{
+    prepare_logdir();
+    size_t max_size = 1024;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/segmented.log");
+    auto first_message = [](const std::string &filename) { return std::stoi(file_contents(filename).substr(13, 4)); };
+    auto link_target = [] {
+        char target[256];
+        auto n = ::readlink("test_logs/segmented.current.log", target, sizeof(target));
+        REQUIRE(n > 0);
+        return std::string(target, static_cast<size_t>(n));
+    };
+
+    {
+        auto sink = std::make_shared<spdlog::sinks::segmented_file_sink_mt>(basename, max_size, 3);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        // 18 bytes per message (with eol): 56 messages per segment
+        for (int i = 0; i < 200; i++)
+        {
+            logger.info("Test message {:04}", i);
+        }
+        logger.flush();
+        REQUIRE(sink->filename() == SPDLOG_FILENAME_T("test_logs/segmented.000004.log"));
+    }
+
+    // the 3 last segments and the link to the active one
+    REQUIRE(count_files("test_logs") == 4);
+    REQUIRE(link_target() == "segmented.000004.log");
+    REQUIRE(first_message("test_logs/segmented.000002.log") == 56);
+    REQUIRE(first_message("test_logs/segmented.000003.log") == 112);
+    REQUIRE(first_message("test_logs/segmented.000004.log") == 168);
+
+    // a new sink appends to the active segment, and deletes only the oldest one when it rotates
+    auto sink = std::make_shared<spdlog::sinks::segmented_file_sink_mt>(basename, max_size, 3);
+    spdlog::logger logger("logger", sink);
+    logger.set_pattern("%v");
+    for (int i = 200; i < 230; i++)
+    {
+        logger.info("Test message {:04}", i);
+    }
+    logger.flush();
+    REQUIRE(count_files("test_logs") == 4);
+    REQUIRE(link_target() == "segmented.000005.log");
+    REQUIRE_FALSE(spdlog::details::os::path_exists("test_logs/segmented.000002.log"));
+    REQUIRE(get_filesize("test_logs/segmented.000004.log") == 56 * 18);
+    REQUIRE(first_message("test_logs/segmented.000005.log") == 224);
+}
+
+TEST_CASE("segmented_file_logger old segments", "[segmented_logger]]")
+{
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    // segments left by a run with a larger max_files, with a gap at 3
+    for (auto seq : {1, 2, 4, 5, 6, 7})
+    {
+        std::ofstream(fmt::format("test_logs/segmented.{:06}.log", seq)) << "segment " << seq << '\n';
+    }
+    std::ofstream("test_logs/segmented.log.bak") << "not a segment\n";
+    REQUIRE(::symlink("segmented.000007.log", "test_logs/segmented.current.log") == 0);
+
+    // everything older than the last max_files segments is deleted, behind the gap too
+    auto sink = std::make_shared<spdlog::sinks::segmented_file_sink_mt>(SPDLOG_FILENAME_T("test_logs/segmented.log"), 1024, 3);
+    REQUIRE(sink->filename() == SPDLOG_FILENAME_T("test_logs/segmented.000007.log"));
+    REQUIRE(count_files("test_logs") == 5);
+    for (auto seq : {1, 2, 4})
+    {
+        REQUIRE_FALSE(spdlog::details::os::path_exists(fmt::format("test_logs/segmented.{:06}.log", seq)));
+    }
+    REQUIRE(spdlog::details::os::path_exists("test_logs/segmented.log.bak"));
+
+    // the next rotation deletes the oldest kept segment
+    spdlog::logger logger("logger", sink);
+    logger.set_pattern("%v");
+    for (int i = 0; i < 60; i++)
+    {
+        logger.info("Test message {:04}", i);
+    }
+    logger.flush();
+    REQUIRE(sink->filename() == SPDLOG_FILENAME_T("test_logs/segmented.000008.log"));
+    REQUIRE(count_files("test_logs") == 5);
+    REQUIRE_FALSE(spdlog::details::os::path_exists("test_logs/segmented.000005.log"));
+}
+#endif
+
+TEST_CASE("level_router_sink", "[level_router]]")
+{
+    prepare_logdir();
+    spdlog::filename_t info_log = SPDLOG_FILENAME_T("test_logs/router_info");
+    spdlog::filename_t error_log = SPDLOG_FILENAME_T("test_logs/router_error");
+    auto sink = std::make_shared<spdlog::sinks::level_router_sink_mt>(spdlog::sinks::level_routes{
+        {spdlog::level::info, info_log}, {spdlog::level::warn, info_log}, {spdlog::level::err, error_log}});
+    sink->set_pattern("%v");
+    REQUIRE(sink->router()->filename(spdlog::level::warn) == info_log);
+    REQUIRE(sink->router()->filename(spdlog::level::debug).empty());
+
+    spdlog::logger logger("logger", sink);
+    logger.set_level(spdlog::level::trace);
+    logger.info("info 1");
+    logger.error("error 1");
+    logger.debug("dropped");
+    logger.warn("warn 1");
+    std::vector<spdlog::details::log_msg> msgs;
+    msgs.emplace_back("logger", spdlog::level::err, "error 2");
+    msgs.emplace_back("logger", spdlog::level::info, "info 2");
+    sink->log_batch(msgs.data(), msgs.size());
+    // buffered until flushed
+    REQUIRE(get_filesize("test_logs/router_info") == 0);
+    logger.flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents("test_logs/router_info") == spdlog::fmt_lib::format("info 1{}warn 1{}info 2{}", default_eol, default_eol, default_eol));
+    REQUIRE(file_contents("test_logs/router_error") == spdlog::fmt_lib::format("error 1{}error 2{}", default_eol, default_eol));
+}
+
+TEST_CASE("level_router_sink buffer full", "[level_router]]")
+{
+    prepare_logdir();
+    size_t buffer_size = 1024;
+    auto logger = spdlog::level_router_logger_mt("logger", {{spdlog::level::info, SPDLOG_FILENAME_T("test_logs/router_info")}}, false, buffer_size);
+    logger->set_pattern("%v");
+    // 100 messages of 18 bytes (with eol): written whenever the buffer fills up
+    for (int i = 0; i < 100; i++)
+    {
+        logger->info("Test message {:04d}", i);
+    }
+    auto written = get_filesize("test_logs/router_info");
+    REQUIRE(written >= buffer_size);
+    REQUIRE(written < 100 * 18);
+    logger->flush();
+    require_message_count("test_logs/router_info", 100);
+    spdlog::drop_all();
+}
+
+TEST_CASE("level_router flush policy", "[level_router]]")
+{
+    prepare_logdir();
+    auto router = std::make_shared<spdlog::sinks::level_router>(spdlog::sinks::level_routes{
+        {spdlog::level::info, SPDLOG_FILENAME_T("test_logs/router_info")}, {spdlog::level::err, SPDLOG_FILENAME_T("test_logs/router_error")}});
+    router->flush_on(spdlog::level::err);
+    auto sink = std::make_shared<spdlog::sinks::level_router_sink_mt>(router);
+    sink->set_pattern("%v");
+    spdlog::logger logger("logger", sink);
+
+    using spdlog::details::os::default_eol;
+    logger.info("info 1");
+    REQUIRE(get_filesize("test_logs/router_info") == 0);
+    // an error drains the whole buffer
+    logger.error("error 1");
+    REQUIRE(file_contents("test_logs/router_info") == spdlog::fmt_lib::format("info 1{}", default_eol));
+    REQUIRE(file_contents("test_logs/router_error") == spdlog::fmt_lib::format("error 1{}", default_eol));
+
+    // the helper thread drains what quiet logging leaves behind
+    router->flush_every(std::chrono::milliseconds(10));
+    auto written = get_filesize("test_logs/router_info");
+    logger.info("info 2");
+    for (int i = 0; i < 500 && get_filesize("test_logs/router_info") == written; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(file_contents("test_logs/router_info") == spdlog::fmt_lib::format("info 1{}info 2{}", default_eol, default_eol));
+}
+
+TEST_CASE("level_router shared", "[level_router]]")
+{
+    prepare_logdir();
+    auto router = std::make_shared<spdlog::sinks::level_router>(spdlog::sinks::level_routes{
+        {spdlog::level::info, SPDLOG_FILENAME_T("test_logs/router_info")}, {spdlog::level::err, SPDLOG_FILENAME_T("test_logs/router_error")}});
+    auto info_sink = std::make_shared<spdlog::sinks::level_router_sink_mt>(router);
+    info_sink->set_pattern("info: %v");
+    auto error_sink = std::make_shared<spdlog::sinks::level_router_sink_st>(router);
+    error_sink->set_pattern("error: %v");
+    spdlog::logger info_logger("info", info_sink);
+    spdlog::logger error_logger("error", error_sink);
+
+    info_logger.info("1");
+    error_logger.error("2");
+    info_logger.info("3");
+    error_logger.flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents("test_logs/router_info") == spdlog::fmt_lib::format("info: 1{}info: 3{}", default_eol, default_eol));
+    REQUIRE(file_contents("test_logs/router_error") == spdlog::fmt_lib::format("error: 2{}", default_eol));
+}
+
+TEST_CASE("level_router_sink fixed file", "[level_router]]")
+{
+    prepare_logdir();
+    spdlog::filename_t info_log = SPDLOG_FILENAME_T("test_logs/router_info");
+    spdlog::filename_t error_log = SPDLOG_FILENAME_T("test_logs/router_error");
+    auto router = std::make_shared<spdlog::sinks::level_router>(
+        spdlog::sinks::level_routes{{spdlog::level::info, info_log}, {spdlog::level::err, error_log}});
+    REQUIRE(router->has_file(error_log));
+    REQUIRE_FALSE(router->has_file(SPDLOG_FILENAME_T("test_logs/router_other")));
+    REQUIRE_THROWS_AS(spdlog::sinks::level_router_sink_mt(router, SPDLOG_FILENAME_T("test_logs/router_other")), spdlog::spdlog_ex);
+
+    // the file of the sink, not the one routed for the level
+    auto sink = std::make_shared<spdlog::sinks::level_router_sink_mt>(router, error_log);
+    sink->set_pattern("%v");
+    spdlog::logger logger("logger", sink);
+    logger.info("info 1");
+    logger.warn("warn 1");
+    logger.flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(get_filesize("test_logs/router_info") == 0);
+    REQUIRE(file_contents("test_logs/router_error") == spdlog::fmt_lib::format("info 1{}warn 1{}", default_eol, default_eol));
+}
+
 // test that passing max_size=0 throws
 TEST_CASE("rotating_file_logger3", "[rotating_logger]]")
 {
@@ -2,6 +2,8 @@
 #include "test_sink.h"
 #include "spdlog/fmt/bin_to_hex.h"
 
+#include <deque>
+
 template<class T>
 std::string log_info(const T &what, spdlog::level::level_enum logger_level = spdlog::level::info)
 {
@@ -230,6 +232,54 @@ TEST_CASE("to_hex_no_ascii", "[to_hex]")
     REQUIRE(ends_with(oss.str(), "090A0B410C4BFFFF" + std::string(spdlog::details::os::default_eol)));
 }
 
+TEST_CASE("to_hex_contiguous", "[to_hex]")
+{
+    // contiguous ranges go through details::hex_dump(), deque iterators through the generic formatter
+    std::vector<unsigned char> v(300);
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        v[i] = static_cast<unsigned char>(i * 7 + 3);
+    }
+    std::deque<unsigned char> d(v.begin(), v.end());
+
+    const char *formats[] = {"{}", "{:X}", "{:s}", "{:p}", "{:n}", "{:a}", "{:Xsa}", "{:pa}", "{:sn}", "{:spa}"};
+    for (auto size : {size_t(0), size_t(1), size_t(15), size_t(16), size_t(17), size_t(33), size_t(64), size_t(100), size_t(300)})
+    {
+        for (auto size_per_line : {size_t(0), size_t(1), size_t(8), size_t(16), size_t(32), size_t(100)})
+        {
+            for (auto format : formats)
+            {
+                auto expected = fmt::format(
+                    SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(d.begin(), d.begin() + static_cast<long>(size), size_per_line));
+                auto contiguous = fmt::format(SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(v.data(), v.data() + size, size_per_line));
+                REQUIRE(contiguous == expected);
+
+                spdlog::memory_buf_t buf;
+                buf.push_back('>');
+                fmt::format_to(std::back_inserter(buf), SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(std::vector<unsigned char>(v.begin(), v.begin() + static_cast<long>(size)), size_per_line));
+                REQUIRE(std::string(buf.data(), buf.size()) == ">" + expected);
+
+                char truncated[40];
+                auto result = fmt::format_to_n(truncated, sizeof(truncated), SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(v.data(), v.data() + size, size_per_line));
+                REQUIRE(result.size == expected.size());
+                REQUIRE(std::string(truncated, std::min(result.size, sizeof(truncated))) == expected.substr(0, sizeof(truncated)));
+            }
+        }
+    }
+}
+
+TEST_CASE("to_hex_large_positions", "[to_hex]")
+{
+    // positions past 0xFFFF take more than 4 digits
+    std::vector<unsigned char> v(70000, 0x41);
+    std::deque<unsigned char> d(v.begin(), v.end());
+    for (auto format : {"{}", "{:a}"})
+    {
+        auto expected = fmt::format(SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(d.begin(), d.end(), 16));
+        REQUIRE(fmt::format(SPDLOG_FMT_RUNTIME(format), spdlog::to_hex(v, 16)) == expected);
+    }
+}
+
 TEST_CASE("default logger API", "[default logger]")
 {
     std::ostringstream oss;
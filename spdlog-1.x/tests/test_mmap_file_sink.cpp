@@ -0,0 +1,128 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/mmap_file_sink.h"
+
+#include <fstream>
+
+#define MMAP_LOG "test_logs/mmap_log"
+
+TEST_CASE("mmap_file_sink", "[mmap_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(MMAP_LOG);
+    std::string expected;
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_mt>(filename, 1024, 2);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Test message {}", 1);
+        logger.info("Test message {}", 2);
+        // mapped at its full size until closed
+        REQUIRE(get_filesize(MMAP_LOG) == 1024);
+    }
+    using spdlog::details::os::default_eol;
+    expected = spdlog::fmt_lib::format("Test message 1{}Test message 2{}", default_eol, default_eol);
+    REQUIRE(file_contents(MMAP_LOG) == expected);
+
+    // appends to the file
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_mt>(filename, 1024, 2);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Test message {}", 3);
+    }
+    expected += spdlog::fmt_lib::format("Test message 3{}", default_eol);
+    REQUIRE(file_contents(MMAP_LOG) == expected);
+}
+
+TEST_CASE("mmap_file_sink unclosed file", "[mmap_file_sink]")
+{
+    prepare_logdir();
+    {
+        // a file left at its mapped size by a crash
+        spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+        std::ofstream file(MMAP_LOG, std::ios::binary);
+        file << "Test message 1\n";
+        file << std::string(1000, '\0');
+    }
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_mt>(SPDLOG_FILENAME_T(MMAP_LOG), 1024, 2);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Test message 2");
+    }
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(MMAP_LOG) == spdlog::fmt_lib::format("Test message 1\nTest message 2{}", default_eol));
+}
+
+TEST_CASE("mmap_file_sink no backups", "[mmap_file_sink]")
+{
+    prepare_logdir();
+    size_t max_size = 64 * 1024;
+    std::string first(10000, 'a');
+    std::string second(60000, 'b');
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_st>(SPDLOG_FILENAME_T(MMAP_LOG), max_size, 0);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        logger.info(first);
+        // does not fit after the first line: the file is replaced, not truncated under the new mapping
+        logger.info(second);
+        logger.info("Test message");
+    }
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(count_files("test_logs") == 1);
+    REQUIRE(file_contents(MMAP_LOG) == spdlog::fmt_lib::format("{}{}Test message{}", second, default_eol, default_eol));
+}
+
+TEST_CASE("mmap_file_sink rotation", "[mmap_file_sink]")
+{
+    prepare_logdir();
+    size_t max_size = 4096;
+    const int threads = 4;
+    const int messages = 10000;
+    {
+        auto sink = std::make_shared<spdlog::sinks::mmap_file_sink_mt>(SPDLOG_FILENAME_T(MMAP_LOG), max_size, 1000);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&logger, t] {
+                for (int i = 0; i < messages; i++)
+                {
+                    logger.info("Thread {} message {}", t, i);
+                }
+            });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // every message is in some file, whole, and the files are within max_size
+    size_t lines = 0;
+    size_t files = 0;
+    for (size_t i = 0;; i++)
+    {
+        auto filename = spdlog::sinks::rotating_file_sink_st::calc_filename(MMAP_LOG, i);
+        if (!spdlog::details::os::path_exists(filename))
+        {
+            break;
+        }
+        auto contents = file_contents(filename);
+        REQUIRE(contents.size() <= max_size);
+        REQUIRE(contents.find('\0') == std::string::npos);
+        REQUIRE((contents.empty() || contents.back() == '\n'));
+        lines += count_lines(filename);
+        files++;
+    }
+    REQUIRE(files > 10);
+    REQUIRE(files == count_files("test_logs"));
+    REQUIRE(lines == static_cast<size_t>(threads * messages));
+}
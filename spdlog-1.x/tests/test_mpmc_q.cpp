@@ -62,6 +62,44 @@ TEST_CASE("enqueue_nowait", "[mpmc_blocking_q]")
     REQUIRE(q.overrun_counter() == 1);
 }
 
+TEST_CASE("dequeue_bulk", "[mpmc_blocking_q]")
+{
+    size_t q_size = 10;
+    spdlog::details::mpmc_blocking_queue<int> q(q_size);
+    for (int i = 0; i < 5; i++)
+    {
+        q.enqueue(i + 0);
+    }
+
+    int items[3] = {-1, -1, -1};
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(0)) == 3);
+    REQUIRE(items[0] == 0);
+    REQUIRE(items[2] == 2);
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(0)) == 2);
+    REQUIRE(items[0] == 3);
+    REQUIRE(items[1] == 4);
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(10)) == 0);
+}
+
+TEST_CASE("try_dequeue_bulk", "[mpmc_blocking_q]")
+{
+    size_t q_size = 10;
+    spdlog::details::mpmc_blocking_queue<int> q(q_size);
+    int items[3] = {-1, -1, -1};
+    REQUIRE(q.try_dequeue_bulk(items, 3) == 0);
+    for (int i = 0; i < 4; i++)
+    {
+        q.enqueue(i + 0);
+    }
+    REQUIRE(q.approx_size() == 4);
+    REQUIRE(q.try_dequeue_bulk(items, 3) == 3);
+    REQUIRE(q.approx_size() == 1);
+    REQUIRE(items[2] == 2);
+    REQUIRE(q.try_dequeue_bulk(items, 3) == 1);
+    REQUIRE(items[0] == 3);
+    REQUIRE(q.size() == 0);
+}
+
 TEST_CASE("bad_queue", "[mpmc_blocking_q]")
 {
     size_t q_size = 0;
@@ -0,0 +1,152 @@
+#include "includes.h"
+#include "spdlog/details/mpsc_ring_q.h"
+
+using std::chrono::milliseconds;
+using test_clock = std::chrono::high_resolution_clock;
+
+static milliseconds millis_from(const test_clock::time_point &tp0)
+{
+    return std::chrono::duration_cast<milliseconds>(test_clock::now() - tp0);
+}
+
+TEST_CASE("ring dequeue-empty-nowait", "[mpsc_ring_q]")
+{
+    spdlog::details::mpsc_ring_queue<int> q(100);
+    milliseconds tolerance_wait(20);
+    int popped_item = 0;
+
+    auto start = test_clock::now();
+    auto rv = q.dequeue_for(popped_item, milliseconds::zero());
+    auto delta_ms = millis_from(start);
+
+    REQUIRE(rv == false);
+    INFO("Delta " << delta_ms.count() << " millis");
+    REQUIRE(delta_ms <= tolerance_wait);
+}
+
+TEST_CASE("ring dequeue-empty-wait", "[mpsc_ring_q]")
+{
+    milliseconds wait_ms(250);
+    milliseconds tolerance_wait(250);
+    spdlog::details::mpsc_ring_queue<int> q(100);
+    int popped_item = 0;
+
+    auto start = test_clock::now();
+    auto rv = q.dequeue_for(popped_item, wait_ms);
+    auto delta_ms = millis_from(start);
+
+    REQUIRE(rv == false);
+    INFO("Delta " << delta_ms.count() << " millis");
+    REQUIRE(delta_ms >= wait_ms - tolerance_wait);
+    REQUIRE(delta_ms <= wait_ms + tolerance_wait);
+}
+
+TEST_CASE("ring capacity", "[mpsc_ring_q]")
+{
+    REQUIRE(spdlog::details::mpsc_ring_queue<int>(0).capacity() == 1);
+    REQUIRE(spdlog::details::mpsc_ring_queue<int>(100).capacity() == 128);
+    REQUIRE(spdlog::details::mpsc_ring_queue<int>(128).capacity() == 128);
+}
+
+TEST_CASE("ring full_queue overrun", "[mpsc_ring_q]")
+{
+    size_t q_size = 128;
+    spdlog::details::mpsc_ring_queue<int> q(q_size);
+    for (int i = 0; i < static_cast<int>(q_size); i++)
+    {
+        q.enqueue(i + 0);
+    }
+    REQUIRE(q.size() == q_size);
+    REQUIRE(q.overrun_counter() == 0);
+
+    q.enqueue_nowait(123456);
+    REQUIRE(q.overrun_counter() == 1);
+    REQUIRE(q.size() == q_size);
+
+    for (int i = 1; i < static_cast<int>(q_size); i++)
+    {
+        int item = -1;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item == i);
+    }
+
+    // last item pushed has overridden the oldest.
+    int item = -1;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)));
+    REQUIRE(item == 123456);
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("ring dequeue_bulk", "[mpsc_ring_q]")
+{
+    spdlog::details::mpsc_ring_queue<int> q(8);
+    for (int i = 0; i < 5; i++)
+    {
+        q.enqueue(i + 0);
+    }
+
+    int items[3] = {-1, -1, -1};
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(0)) == 3);
+    REQUIRE(items[0] == 0);
+    REQUIRE(items[2] == 2);
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(0)) == 2);
+    REQUIRE(items[0] == 3);
+    REQUIRE(items[1] == 4);
+    REQUIRE(q.dequeue_bulk_for(items, 3, milliseconds(10)) == 0);
+}
+
+TEST_CASE("ring wake parked consumer", "[mpsc_ring_q]")
+{
+    spdlog::details::mpsc_ring_queue<int> q(16);
+    std::thread producer([&q] {
+        std::this_thread::sleep_for(milliseconds(50));
+        q.enqueue(42);
+    });
+
+    int item = -1;
+    auto start = test_clock::now();
+    auto rv = q.dequeue_for(item, milliseconds(5000));
+    auto delta_ms = millis_from(start);
+    producer.join();
+
+    REQUIRE(rv);
+    REQUIRE(item == 42);
+    INFO("Delta " << delta_ms.count() << " millis");
+    REQUIRE(delta_ms < milliseconds(1000));
+}
+
+TEST_CASE("ring multi producers", "[mpsc_ring_q]")
+{
+    size_t n_threads = 8;
+    size_t per_thread = 10000;
+    spdlog::details::mpsc_ring_queue<size_t> q(64);
+
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        producers.emplace_back([&q, t, per_thread] {
+            for (size_t i = 0; i < per_thread; i++)
+            {
+                q.enqueue(t * per_thread + i);
+            }
+        });
+    }
+
+    // items of a single producer must arrive in order
+    std::vector<size_t> next(n_threads, 0);
+    for (size_t received = 0; received < n_threads * per_thread; received++)
+    {
+        size_t item = 0;
+        REQUIRE(q.dequeue_for(item, milliseconds(5000)));
+        size_t t = item / per_thread;
+        REQUIRE(item % per_thread == next[t]);
+        next[t]++;
+    }
+
+    for (auto &p : producers)
+    {
+        p.join();
+    }
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.overrun_counter() == 0);
+}
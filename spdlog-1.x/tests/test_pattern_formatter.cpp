@@ -1,5 +1,6 @@
 #include "includes.h"
 #include "test_sink.h"
+#include "spdlog/static_pattern_formatter.h"
 
 using spdlog::memory_buf_t;
 using spdlog::details::fmt_helper::to_string_view;
@@ -499,3 +500,66 @@ TEST_CASE("override need_localtime", "[pattern_formatter]")
         REQUIRE(to_string_view(formatted) == oss.str());
     }
 }
+
+TEST_CASE("static pattern formatter", "[pattern_formatter]")
+{
+    using namespace spdlog::static_pattern;
+    using static_formatter = spdlog::static_pattern_formatter<text<'['>, flag<'D'>, text<' '>, flag<'H'>, text<':'>, flag<'M'>,
+        text<':'>, flag<'S'>, text<':'>, flag<'f'>, text<']', '['>, flag<'n'>, text<']', '['>, flag<'^'>, flag<'L'>, flag<'$'>,
+        text<']', ' ', ':', ' '>, flag<'v'>, text<' ', '%'>>;
+
+    REQUIRE(static_formatter::pattern() == "[%D %H:%M:%S:%f][%n][%^%L%$] : %v %%");
+
+    for (auto time_type : {spdlog::pattern_time_type::local, spdlog::pattern_time_type::utc})
+    {
+        static_formatter formatter(time_type, "\n");
+        spdlog::pattern_formatter runtime_formatter(static_formatter::pattern(), time_type, "\n");
+        REQUIRE(formatter.key() == runtime_formatter.key());
+        REQUIRE(formatter.clone()->key() == formatter.key());
+
+        for (auto lvl : {spdlog::level::info, spdlog::level::critical})
+        {
+            spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", lvl, "some message");
+            memory_buf_t formatted;
+            memory_buf_t expected;
+            formatter.format(msg, formatted);
+            size_t start = msg.color_range_start;
+            size_t end = msg.color_range_end;
+            runtime_formatter.format(msg, expected);
+            REQUIRE(to_string_view(formatted) == to_string_view(expected));
+            REQUIRE(start == msg.color_range_start);
+            REQUIRE(end == msg.color_range_end);
+            REQUIRE(end > start);
+        }
+    }
+}
+
+TEST_CASE("cached date time prefix", "[pattern_formatter]")
+{
+    using namespace spdlog::static_pattern;
+    using static_formatter = spdlog::static_pattern_formatter<text<'['>, flag<'Y'>, text<'-'>, flag<'m'>, text<'-'>, flag<'d'>,
+        text<' '>, flag<'H'>, text<':'>, flag<'M'>, text<':'>, flag<'S'>, text<'.'>, flag<'f'>, text<']', ' '>, flag<'v'>>;
+
+    spdlog::pattern_formatter runtime_formatter("[%Y-%m-%d %H:%M:%S.%f] [%-5H] %v", spdlog::pattern_time_type::utc, "");
+    static_formatter formatter(spdlog::pattern_time_type::utc, "");
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info, "msg");
+
+    auto format_at = [&](spdlog::formatter &f, std::chrono::microseconds since_epoch) {
+        msg.time = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(since_epoch));
+        memory_buf_t formatted;
+        f.format(msg, formatted);
+        return std::string(formatted.data(), formatted.size());
+    };
+
+    using std::chrono::microseconds;
+    const microseconds day = std::chrono::hours(24);
+    REQUIRE(format_at(runtime_formatter, day + microseconds(1)) == "[1970-01-02 00:00:00.000001] [00   ] msg");
+    REQUIRE(format_at(runtime_formatter, day + microseconds(999999)) == "[1970-01-02 00:00:00.999999] [00   ] msg");
+    REQUIRE(format_at(runtime_formatter, day + microseconds(3601000002)) == "[1970-01-02 01:00:01.000002] [01   ] msg");
+    REQUIRE(format_at(runtime_formatter, day + microseconds(3)) == "[1970-01-02 00:00:00.000003] [00   ] msg");
+
+    REQUIRE(format_at(formatter, day + microseconds(1)) == "[1970-01-02 00:00:00.000001] msg");
+    REQUIRE(format_at(formatter, day + microseconds(999999)) == "[1970-01-02 00:00:00.999999] msg");
+    REQUIRE(format_at(formatter, day + microseconds(3601000002)) == "[1970-01-02 01:00:01.000002] msg");
+    REQUIRE(format_at(formatter, day + microseconds(3)) == "[1970-01-02 00:00:00.000003] msg");
+}
@@ -0,0 +1,166 @@
+#include "includes.h"
+#include "spdlog/details/per_thread_q.h"
+
+using std::chrono::milliseconds;
+using test_clock = std::chrono::high_resolution_clock;
+
+namespace {
+struct stamped_item
+{
+    spdlog::log_clock::time_point time;
+    size_t value = 0;
+};
+
+stamped_item make_item(size_t value)
+{
+    stamped_item item;
+    item.time = spdlog::log_clock::now();
+    item.value = value;
+    return item;
+}
+} // namespace
+
+TEST_CASE("per thread dequeue-empty", "[per_thread_q]")
+{
+    spdlog::details::per_thread_queue<stamped_item> q(16);
+    stamped_item item;
+
+    auto start = test_clock::now();
+    REQUIRE(q.dequeue_for(item, milliseconds(50)) == false);
+    REQUIRE(test_clock::now() - start >= milliseconds(25));
+    REQUIRE(q.producers() == 0);
+}
+
+TEST_CASE("per thread overrun", "[per_thread_q]")
+{
+    spdlog::details::per_thread_queue<stamped_item> q(4);
+    for (size_t i = 0; i < 4; i++)
+    {
+        q.enqueue(make_item(i));
+    }
+    // the consumer alone takes items out of a ring: the new item is discarded
+    q.enqueue_nowait(make_item(4));
+    REQUIRE(q.overrun_counter() == 1);
+    REQUIRE(q.size() == 4);
+    REQUIRE(q.load() == 1.0f);
+    REQUIRE(q.producers() == 1);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        stamped_item item;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item.value == i);
+    }
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("per thread own capacity", "[per_thread_q]")
+{
+    spdlog::details::per_thread_queue<stamped_item> q(4);
+    for (size_t i = 0; i < 4; i++)
+    {
+        q.enqueue(make_item(i));
+    }
+    REQUIRE_FALSE(q.enqueue_if_have_room(make_item(100)));
+
+    // a full ring does not take room from the ring of another thread
+    size_t accepted = 0;
+    float other_load = 0;
+    std::thread other([&q, &accepted, &other_load] {
+        other_load = q.load();
+        for (size_t i = 4; i < 9; i++)
+        {
+            accepted += q.enqueue_if_have_room(make_item(i)) ? 1 : 0;
+        }
+    });
+    other.join();
+    REQUIRE(other_load == 0.0f);
+    REQUIRE(accepted == 4);
+    REQUIRE(q.size() == 8);
+    REQUIRE(q.load() == 1.0f);
+    REQUIRE(q.producers() == 2);
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        stamped_item item;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item.value == i);
+    }
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.load() == 0.0f);
+}
+
+TEST_CASE("per thread merge by time", "[per_thread_q]")
+{
+    spdlog::details::per_thread_queue<stamped_item> q(16);
+    auto base = spdlog::log_clock::now();
+
+    // each thread enqueues items stamped in a fixed interleaved order
+    std::thread odd([&q, base] {
+        for (size_t i = 1; i < 10; i += 2)
+        {
+            stamped_item item;
+            item.time = base + std::chrono::microseconds(i);
+            item.value = i;
+            q.enqueue(std::move(item));
+        }
+    });
+    std::thread even([&q, base] {
+        for (size_t i = 0; i < 10; i += 2)
+        {
+            stamped_item item;
+            item.time = base + std::chrono::microseconds(i);
+            item.value = i;
+            q.enqueue(std::move(item));
+        }
+    });
+    odd.join();
+    even.join();
+
+    for (size_t i = 0; i < 10; i++)
+    {
+        stamped_item item;
+        REQUIRE(q.dequeue_for(item, milliseconds(0)));
+        REQUIRE(item.value == i);
+    }
+}
+
+TEST_CASE("per thread multi producers", "[per_thread_q]")
+{
+    size_t n_threads = 8;
+    size_t per_thread = 5000;
+    spdlog::details::per_thread_queue<stamped_item> q(32);
+
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < n_threads; t++)
+    {
+        producers.emplace_back([&q, t, per_thread] {
+            for (size_t i = 0; i < per_thread; i++)
+            {
+                q.enqueue(make_item(t * per_thread + i));
+            }
+        });
+    }
+
+    // items of a single producer must arrive in order
+    std::vector<size_t> next(n_threads, 0);
+    for (size_t received = 0; received < n_threads * per_thread; received++)
+    {
+        stamped_item item;
+        REQUIRE(q.dequeue_for(item, milliseconds(5000)));
+        size_t t = item.value / per_thread;
+        REQUIRE(item.value % per_thread == next[t]);
+        next[t]++;
+    }
+
+    for (auto &p : producers)
+    {
+        p.join();
+    }
+
+    // the rings of the exited threads are reclaimed once drained
+    stamped_item item;
+    REQUIRE(q.dequeue_for(item, milliseconds(0)) == false);
+    REQUIRE(q.producers() == 0);
+    REQUIRE(q.overrun_counter() == 0);
+}
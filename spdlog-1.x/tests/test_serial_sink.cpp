@@ -0,0 +1,166 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/serial_sink.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sstream>
+
+namespace {
+// pseudo terminal pair: the sink writes to the slave, the test reads the master
+struct pty_pair
+{
+    int master = -1;
+    std::string slave;
+
+    pty_pair()
+    {
+        master = ::posix_openpt(O_RDWR | O_NOCTTY);
+        REQUIRE(master >= 0);
+        REQUIRE(::grantpt(master) == 0);
+        REQUIRE(::unlockpt(master) == 0);
+        slave = ::ptsname(master);
+    }
+
+    ~pty_pair()
+    {
+        ::close(master);
+    }
+
+    // read what is available, waiting up to timeout_ms for the first bytes
+    std::string read_available(int timeout_ms = 100)
+    {
+        std::string result;
+        char buf[4096];
+        pollfd pfd{master, POLLIN, 0};
+        while (::poll(&pfd, 1, timeout_ms) > 0)
+        {
+            auto n = ::read(master, buf, sizeof(buf));
+            if (n <= 0)
+            {
+                break;
+            }
+            result.append(buf, static_cast<size_t>(n));
+            timeout_ms = 10;
+        }
+        return result;
+    }
+};
+
+// check that every line is "msg <n>" with increasing n, return the number of lines
+size_t check_lines(const std::string &output)
+{
+    std::istringstream in(output);
+    std::string line;
+    size_t lines = 0;
+    long last = -1;
+    while (std::getline(in, line))
+    {
+        REQUIRE(line.compare(0, 4, "msg ") == 0);
+        long n = std::stol(line.substr(4));
+        REQUIRE(n > last);
+        last = n;
+        lines++;
+    }
+    REQUIRE((output.empty() || output.back() == '\n'));
+    return lines;
+}
+} // namespace
+
+TEST_CASE("serial_sink", "[serial_sink]")
+{
+    pty_pair pty;
+    auto sink = std::make_shared<spdlog::sinks::serial_sink_mt>(spdlog::sinks::serial_sink_config(pty.slave, 115200));
+    spdlog::logger logger("serial", sink);
+    logger.set_pattern("%v");
+
+    logger.info("msg {}", 1);
+    logger.info("msg {}", 2);
+    logger.flush();
+
+    REQUIRE(pty.read_available() == "msg 1\nmsg 2\n");
+    REQUIRE(sink->pending_bytes() == 0);
+    REQUIRE(sink->dropped_count() == 0);
+}
+
+TEST_CASE("serial_sink drop", "[serial_sink]")
+{
+    pty_pair pty;
+    spdlog::sinks::serial_sink_config config(pty.slave);
+    config.buffer_size = 1024;
+    auto sink = std::make_shared<spdlog::sinks::serial_sink_mt>(config);
+    spdlog::logger logger("serial", sink);
+    logger.set_pattern("%v");
+
+    // nobody reads the master: the line fills up, then the ring, then messages are dropped
+    const size_t messages = 100000;
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger.info("msg {}", i);
+    }
+    REQUIRE(sink->dropped_count() > 0);
+    REQUIRE(sink->pending_bytes() <= config.buffer_size);
+
+    // what got through is whole lines, in order
+    size_t received = 0;
+    for (int i = 0; i < 100 && (received == 0 || sink->pending_bytes() > 0); i++)
+    {
+        auto output = pty.read_available();
+        logger.flush();
+        output += pty.read_available();
+        received += check_lines(output);
+    }
+    REQUIRE(sink->pending_bytes() == 0);
+    REQUIRE(received + sink->dropped_count() == messages);
+}
+
+TEST_CASE("serial_sink block", "[serial_sink]")
+{
+    pty_pair pty;
+    spdlog::sinks::serial_sink_config config(pty.slave);
+    config.buffer_size = 1024;
+    config.overflow_policy = spdlog::sinks::serial_overflow_policy::block;
+    auto sink = std::make_shared<spdlog::sinks::serial_sink_mt>(config);
+    spdlog::logger logger("serial", sink);
+    logger.set_pattern("%v");
+
+    const size_t messages = 20000;
+    std::string output;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done)
+        {
+            output += pty.read_available(10);
+        }
+    });
+    for (size_t i = 0; i < messages; i++)
+    {
+        logger.info("msg {}", i);
+    }
+    for (int i = 0; i < 100 && sink->pending_bytes() > 0; i++)
+    {
+        logger.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    done = true;
+    reader.join();
+    output += pty.read_available();
+
+    REQUIRE(sink->dropped_count() == 0);
+    REQUIRE(check_lines(output) == messages);
+}
+
+#ifndef SPDLOG_NO_EXCEPTIONS
+TEST_CASE("serial_sink errors", "[serial_sink]")
+{
+    pty_pair pty;
+    REQUIRE_THROWS_AS(spdlog::sinks::serial_sink_mt(spdlog::sinks::serial_sink_config(pty.slave, 12345)), spdlog::spdlog_ex);
+    REQUIRE_THROWS_AS(spdlog::sinks::serial_sink_mt(spdlog::sinks::serial_sink_config("test_logs/no_such_dir/tty")), spdlog::spdlog_ex);
+}
+#endif
@@ -27,6 +27,19 @@ public:
         return msg_counter_;
     }
 
+    size_t batch_counter()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return batch_counter_;
+    }
+
+    // number of batches received already formatted by the logger
+    size_t formatted_batch_counter()
+    {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return formatted_batch_counter_;
+    }
+
     size_t flush_counter()
     {
         std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
@@ -51,6 +64,29 @@ protected:
     {
         memory_buf_t formatted;
         base_sink<Mutex>::formatter_->format(msg, formatted);
+        save_(formatted);
+    }
+
+    void sink_batch_(const details::log_msg *msgs, size_t count) override
+    {
+        batch_counter_++;
+        base_sink<Mutex>::sink_batch_(msgs, count);
+    }
+
+    void sink_formatted_batch_(const details::log_msg *msgs, const details::formatted_msg *formatted, size_t count) override
+    {
+        formatted_batch_counter_++;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (base_sink<Mutex>::should_log(msgs[i].level))
+            {
+                save_(formatted[i].buf);
+            }
+        }
+    }
+
+    void save_(const memory_buf_t &formatted)
+    {
         // save the line without the eol
         auto eol_len = strlen(details::os::default_eol);
         if (lines_.size() < lines_to_save)
@@ -68,6 +104,8 @@ protected:
 
     size_t msg_counter_{0};
     size_t flush_counter_{0};
+    size_t batch_counter_{0};
+    size_t formatted_batch_counter_{0};
     std::chrono::milliseconds delay_{std::chrono::milliseconds::zero()};
     std::vector<std::string> lines_;
 };
@@ -0,0 +1,147 @@
+/*
+ * This content is released under the MIT License as specified in https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/uring_file_sink.h"
+
+#define URING_LOG "test_logs/uring_log"
+
+namespace {
+// log 10000 messages through a uring_file_sink with small buffers and check the file
+void log_and_check(bool use_uring)
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(URING_LOG);
+    std::string expected;
+    {
+        // 2 buffers of 1 KB: most messages are written while the other buffer is in flight
+        auto sink = std::make_shared<spdlog::sinks::uring_file_sink_mt>(filename, true, 2, 1024, use_uring);
+        if (!use_uring)
+        {
+            REQUIRE_FALSE(sink->uses_uring());
+        }
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 10000; i++)
+        {
+            logger.info("Test message {}", i);
+            expected += spdlog::fmt_lib::format("Test message {}{}", i, spdlog::details::os::default_eol);
+        }
+        logger.flush();
+        REQUIRE(file_contents(URING_LOG) == expected);
+
+        // a message larger than a buffer
+        std::string big(3000, 'x');
+        logger.info(big);
+        expected += big + spdlog::details::os::default_eol;
+    }
+    // destroyed sink wrote everything
+    REQUIRE(file_contents(URING_LOG) == expected);
+
+    // appends to the file
+    {
+        auto sink = std::make_shared<spdlog::sinks::uring_file_sink_mt>(filename, false, 2, 1024, use_uring);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Appended");
+    }
+    expected += spdlog::fmt_lib::format("Appended{}", spdlog::details::os::default_eol);
+    REQUIRE(file_contents(URING_LOG) == expected);
+}
+} // namespace
+
+TEST_CASE("uring_file_sink", "[uring_file_sink]")
+{
+    log_and_check(true);
+}
+
+TEST_CASE("uring_file_sink write fallback", "[uring_file_sink]")
+{
+    log_and_check(false);
+}
+
+TEST_CASE("uring_file_sink batch", "[uring_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(URING_LOG);
+    auto sink = std::make_shared<spdlog::sinks::uring_file_sink_st>(filename, true, 2, 64);
+    sink->set_pattern("%v");
+    sink->set_level(spdlog::level::info);
+
+    std::vector<spdlog::details::log_msg> msgs;
+    msgs.emplace_back("logger", spdlog::level::info, "Test message 1");
+    msgs.emplace_back("logger", spdlog::level::debug, "Filtered message");
+    msgs.emplace_back("logger", spdlog::level::warn, "Test message 2");
+    sink->log_batch(msgs.data(), msgs.size());
+    sink->flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(URING_LOG) == spdlog::fmt_lib::format("Test message 1{}Test message 2{}", default_eol, default_eol));
+}
+
+TEST_CASE("uring_file_sink shared file", "[uring_file_sink]")
+{
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(URING_LOG);
+    // two writers on one file (e.g. two processes) append instead of overwriting each other
+    auto first = std::make_shared<spdlog::sinks::uring_file_sink_st>(filename, true, 2, 64);
+    auto second = std::make_shared<spdlog::sinks::uring_file_sink_st>(filename, false, 2, 64);
+    first->set_pattern("%v");
+    second->set_pattern("%v");
+    first->log(spdlog::details::log_msg("logger", spdlog::level::info, "First"));
+    first->flush();
+    second->log(spdlog::details::log_msg("logger", spdlog::level::info, "Second"));
+    second->flush();
+    first->log(spdlog::details::log_msg("logger", spdlog::level::info, "Third"));
+    first->flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(URING_LOG) == spdlog::fmt_lib::format("First{}Second{}Third{}", default_eol, default_eol, default_eol));
+}
+
+TEST_CASE("rotating_uring_file_sink", "[uring_file_sink]")
+{
+    prepare_logdir();
+    size_t max_size = 4096;
+    const int messages = 10000;
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_uring_file_sink_mt>(SPDLOG_FILENAME_T(URING_LOG), max_size, 1000, 2, 1024);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < messages; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+
+    // every message is in one of the files, none of them is larger than max_size
+    size_t files = 0;
+    size_t lines = 0;
+    for (size_t i = 0;; i++)
+    {
+        auto filename = spdlog::sinks::rotating_file_sink_st::calc_filename(URING_LOG, i);
+        if (!spdlog::details::os::path_exists(filename))
+        {
+            break;
+        }
+        REQUIRE(get_filesize(filename) <= max_size);
+        lines += count_lines(filename);
+        files++;
+    }
+    REQUIRE(files > 10);
+    REQUIRE(files == count_files("test_logs"));
+    REQUIRE(lines == static_cast<size_t>(messages));
+
+    // the oldest files beyond max_files are deleted
+    prepare_logdir();
+    {
+        auto sink = std::make_shared<spdlog::sinks::rotating_uring_file_sink_st>(SPDLOG_FILENAME_T(URING_LOG), max_size, 2);
+        spdlog::logger logger("logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < messages; i++)
+        {
+            logger.info("Test message {}", i);
+        }
+    }
+    REQUIRE(count_files("test_logs") == 3);
+}